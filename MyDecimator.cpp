@@ -0,0 +1,120 @@
+#include "MyDecimator.h"
+#include <cmath>
+#include <cstring>
+
+/*******************************************************************************
+ * MyHalfbandDecimator.
+ ******************************************************************************/
+MyHalfbandDecimator::MyHalfbandDecimator()
+{
+    // Blackman windowed sinc with cutoff at a quarter of the input rate.
+    // Only odd offsets from the center are non zero.
+    const double center = (NUM_TAPS - 1) / 2.0;
+
+    for(int i = 0; i < NUM_PAIRS; i++)
+    {
+        const int offset = 2 * i + 1;
+        const double x = M_PI * offset / 2.0;
+        const double n = center + offset;
+        const double w = 0.42 - 0.5 * cos(2.0 * M_PI * n / (NUM_TAPS - 1))
+                       + 0.08 * cos(4.0 * M_PI * n / (NUM_TAPS - 1));
+
+        _coefs[i] = static_cast<float>(0.5 * sin(x) / x * w);
+    }
+
+    Reset();
+}
+
+void MyHalfbandDecimator::Reset()
+{
+    memset(_delay, 0, sizeof(_delay));
+    _pos = 0;
+}
+
+void MyHalfbandDecimator::Process(const float* in,
+                                  float* out,
+                                  const unsigned long& outFrames,
+                                  const int& stride)
+{
+    const int center = (NUM_TAPS - 1) / 2;
+
+    for(unsigned long i = 0; i < outFrames; i++)
+    {
+        // Both inputs are read before out[i] is written, which makes the
+        // in place case safe.
+        for(int k = 0; k < 2; k++)
+        {
+            _delay[_pos] = _delay[_pos + NUM_TAPS] = in[(2 * i + k) * stride];
+
+            if(++_pos == NUM_TAPS)
+            {
+                _pos = 0;
+            }
+        }
+
+        const float* window = _delay + _pos;
+        float sum = 0.5f * window[center];
+
+        for(int p = 0; p < NUM_PAIRS; p++)
+        {
+            const int offset = 2 * p + 1;
+            sum += _coefs[p] * (window[center - offset] +
+                                window[center + offset]);
+        }
+
+        out[i * stride] = sum;
+    }
+}
+
+/*******************************************************************************
+ * MyDecimator.
+ ******************************************************************************/
+MyDecimator::MyDecimator():
+_factor(1),
+_numStages(0)
+{
+
+}
+
+void MyDecimator::SetFactor(const int& factor)
+{
+    switch(factor)
+    {
+        case 2: _numStages = 1; break;
+        case 4: _numStages = 2; break;
+        case 8: _numStages = 3; break;
+        default: _numStages = 0; break;
+    }
+
+    _factor = 1 << _numStages;
+    Reset();
+}
+
+void MyDecimator::Reset()
+{
+    for(int c = 0; c < MAX_CHANNELS; c++)
+    {
+        for(int s = 0; s < MAX_STAGES; s++)
+        {
+            _stages[c][s].Reset();
+        }
+    }
+}
+
+void MyDecimator::Process(float* buffer,
+                          const unsigned long& frames,
+                          const int& numChannels)
+{
+    unsigned long stageFrames = frames * _factor;
+
+    for(int s = 0; s < _numStages; s++)
+    {
+        stageFrames /= 2;
+
+        for(int c = 0; c < numChannels; c++)
+        {
+            _stages[c][s].Process(buffer + c, buffer + c,
+                                  stageFrames, numChannels);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef __MY_DECIMATOR__
+#define __MY_DECIMATOR__
+
+/// 2:1 halfband FIR decimator.
+/// Every other tap of a halfband filter is zero and the rest are symmetric,
+/// so each output sample only costs NUM_PAIRS multiplies.
+class MyHalfbandDecimator
+{
+public:
+    MyHalfbandDecimator();
+
+    void Reset();
+
+    /// Reads 2 * outFrames samples from in and writes outFrames samples to
+    /// out, both with the given stride. Can run in place (in == out).
+    void Process(const float* in,
+                 float* out,
+                 const unsigned long& outFrames,
+                 const int& stride);
+
+    static const int NUM_PAIRS = 8;
+    static const int NUM_TAPS = 4 * NUM_PAIRS - 1;
+
+private:
+    float _coefs[NUM_PAIRS];
+
+    // Doubled delay line so a full window is always contiguous.
+    float _delay[2 * NUM_TAPS];
+    int _pos;
+};
+
+/// Cascade of halfband stages bringing an oversampled interleaved buffer
+/// back to the base rate. Factor is 1, 2, 4 or 8.
+class MyDecimator
+{
+public:
+    MyDecimator();
+
+    void SetFactor(const int& factor);
+
+    int GetFactor() const
+    {
+        return _factor;
+    }
+
+    void Reset();
+
+    /// buffer holds frames * factor interleaved frames of numChannels.
+    /// The first frames frames are overwritten with the decimated signal.
+    void Process(float* buffer,
+                 const unsigned long& frames,
+                 const int& numChannels);
+
+    static const int MAX_CHANNELS = 2;
+    static const int MAX_STAGES = 3;
+
+private:
+    MyHalfbandDecimator _stages[MAX_CHANNELS][MAX_STAGES];
+    int _factor;
+    int _numStages;
+};
+
+#endif // __MY_DECIMATOR__
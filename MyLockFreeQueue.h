@@ -0,0 +1,84 @@
+#ifndef __MY_LOCK_FREE_QUEUE__
+#define __MY_LOCK_FREE_QUEUE__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/// Single producer / single consumer ring buffer.
+/// Push and Pop never lock or allocate, so one side can be the audio thread.
+/// Size must be a power of two.
+///
+/// Cache line aligned, which operator new before C++17 doesn't honour: own
+/// it through a pointer rather than as a member of a class allocated with
+/// new, new here aligns it.
+template<typename T, std::size_t Size>
+class MyLockFreeQueue
+{
+public:
+    static_assert(Size >= 2 && (Size & (Size - 1)) == 0,
+                  "MyLockFreeQueue size must be a power of two.");
+
+    /// Producer side. Returns false when the queue is full.
+    bool Push(const T& value)
+    {
+        const std::size_t write = _write.load(std::memory_order_relaxed);
+
+        if(write - _read.load(std::memory_order_acquire) == Size)
+        {
+            return false;
+        }
+
+        _data[write & (Size - 1)] = value;
+        _write.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer side. Returns false when the queue is empty.
+    bool Pop(T& value)
+    {
+        const std::size_t read = _read.load(std::memory_order_relaxed);
+
+        if(read == _write.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        value = _data[read & (Size - 1)];
+        _read.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool IsEmpty() const
+    {
+        return _read.load(std::memory_order_acquire) ==
+               _write.load(std::memory_order_acquire);
+    }
+
+    static void* operator new(std::size_t size)
+    {
+        void* p = nullptr;
+
+        if(posix_memalign(&p, alignof(MyLockFreeQueue), size) != 0)
+        {
+            throw std::bad_alloc();
+        }
+
+        return p;
+    }
+
+    static void operator delete(void* p)
+    {
+        free(p);
+    }
+
+private:
+    T _data[Size];
+
+    // Separate cache lines so producer and consumer don't false-share.
+    alignas(64) std::atomic<std::size_t> _write = {0};
+    alignas(64) std::atomic<std::size_t> _read = {0};
+};
+
+#endif // __MY_LOCK_FREE_QUEUE__
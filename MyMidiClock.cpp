@@ -0,0 +1,50 @@
+#include "MyMidiClock.h"
+
+/*******************************************************************************
+ * MyMidiClock.
+ ******************************************************************************/
+MyMidiClock::MyMidiClock():
+_sampleRate(44100.0)
+{
+    Reset();
+}
+
+void MyMidiClock::SetSampleRate(const double& sampleRate)
+{
+    _sampleRate = sampleRate;
+    Reset();
+}
+
+void MyMidiClock::Reset()
+{
+    _lastFrame = 0.0;
+    _period = 0.0;
+    _count = 0;
+}
+
+void MyMidiClock::Tick(const double& frame)
+{
+    const double interval = frame - _lastFrame;
+    
+    if(_count > 0 && interval > 0.0)
+    {
+        if(_period <= 0.0)
+        {
+            _period = interval;
+        }
+        else if(interval < 4.0 * _period)
+        {
+            // About a quarter note to settle after a tempo change.
+            _period += (interval - _period) * 0.1;
+        }
+    }
+    
+    _lastFrame = frame;
+    ++_count;
+}
+
+double MyMidiClock::GetBpm() const
+{
+    return _period > 0.0 ? 60.0 * _sampleRate /
+                           (_period * TICKS_PER_QUARTER) : 0.0;
+}
@@ -0,0 +1,48 @@
+#ifndef __MY_MIDI_CLOCK__
+#define __MY_MIDI_CLOCK__
+
+/// Tempo of an incoming MIDI clock (24 ticks per quarter note).
+/// Tick intervals are smoothed with a one pole, so the jitter of the
+/// sender and of the transport doesn't reach the step grid. A gap of more
+/// than four ticks (sender paused) is left out.
+class MyMidiClock
+{
+public:
+    MyMidiClock();
+    
+    void SetSampleRate(const double& sampleRate);
+    void Reset();
+    
+    /// A clock message landing on frame (any running count).
+    void Tick(const double& frame);
+    
+    /// Ticks since Reset.
+    long GetTickCount() const
+    {
+        return _count;
+    }
+    
+    /// Once two ticks are in.
+    bool HasTempo() const
+    {
+        return _period > 0.0;
+    }
+    
+    /// Smoothed frames per tick.
+    double GetPeriod() const
+    {
+        return _period;
+    }
+    
+    double GetBpm() const;
+    
+    static const int TICKS_PER_QUARTER = 24;
+    
+private:
+    double _sampleRate;
+    double _lastFrame;
+    double _period;
+    long _count;
+};
+
+#endif // __MY_MIDI_CLOCK__
@@ -0,0 +1,159 @@
+#include "MyMidiInput.h"
+#include "MyProfiler.h"
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+/*******************************************************************************
+ * MyMidiParser.
+ ******************************************************************************/
+MyMidiParser::MyMidiParser():
+_status(0),
+_count(0),
+_needed(0)
+{
+
+}
+
+bool MyMidiParser::Parse(const unsigned char& byte, MyMidiMessage& msg)
+{
+    // Real time bytes can show up anywhere and don't touch running status.
+    if(byte >= 0xF8)
+    {
+        msg.status = byte;
+        msg.data1 = msg.data2 = 0;
+        return true;
+    }
+    
+    if(byte & 0x80)
+    {
+        _count = 0;
+        
+        if(byte < 0xF0)
+        {
+            const unsigned char type = byte & 0xF0;
+            _status = byte;
+            _needed = (type == 0xC0 || type == 0xD0) ? 1 : 2;
+        }
+        else
+        {
+            // System common and sysex, skipped up to the next status byte.
+            _status = 0;
+        }
+        
+        return false;
+    }
+    
+    if(_status == 0)
+    {
+        return false;
+    }
+    
+    _data[_count++] = byte;
+    
+    if(_count < _needed)
+    {
+        return false;
+    }
+    
+    // Running status, the next data bytes reuse _status.
+    _count = 0;
+    msg.status = _status;
+    msg.data1 = _data[0];
+    msg.data2 = _needed > 1 ? _data[1] : 0;
+    return true;
+}
+
+/*******************************************************************************
+ * MyMidiInput.
+ ******************************************************************************/
+MyMidiInput::MyMidiInput():
+_fd(-1),
+_listener(nullptr),
+_quit(false)
+{
+
+}
+
+MyMidiInput::~MyMidiInput()
+{
+    Close();
+}
+
+bool MyMidiInput::Open(const std::string& path, Listener* listener)
+{
+    Close();
+    
+    // Read-write keeps a named pipe open between writers instead of
+    // hitting end of file, rawmidi devices don't mind.
+    _fd = open(path.c_str(), O_RDWR | O_NONBLOCK);
+    
+    if(_fd < 0)
+    {
+        _fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+    }
+    
+    if(_fd < 0)
+    {
+        return false;
+    }
+    
+    _listener = listener;
+    _quit = false;
+    _thread = std::thread(&MyMidiInput::ReadLoop, this);
+    return true;
+}
+
+void MyMidiInput::Close()
+{
+    if(_fd < 0)
+    {
+        return;
+    }
+    
+    _quit = true;
+    _thread.join();
+    close(_fd);
+    _fd = -1;
+}
+
+void MyMidiInput::ReadLoop()
+{
+    MyMidiParser parser;
+    MyMidiMessage msg;
+    unsigned char buffer[256];
+    
+    while(!_quit)
+    {
+        // Wakes up now and then to notice Close.
+        pollfd p = { _fd, POLLIN, 0 };
+        
+        if(poll(&p, 1, 100) <= 0)
+        {
+            continue;
+        }
+        
+        const double time = MyProfiler::Now();
+        const ssize_t n = read(_fd, buffer, sizeof(buffer));
+        
+        if(n <= 0)
+        {
+            // Nobody on the other end of a read only pipe.
+            if(n == 0)
+            {
+                usleep(10000);
+            }
+            
+            continue;
+        }
+        
+        for(ssize_t i = 0; i < n; i++)
+        {
+            if(parser.Parse(buffer[i], msg))
+            {
+                msg.time = time;
+                _listener->OnMidi(msg);
+            }
+        }
+    }
+}
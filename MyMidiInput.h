@@ -0,0 +1,82 @@
+#ifndef __MY_MIDI_INPUT__
+#define __MY_MIDI_INPUT__
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+/// One channel or real time message with the time it was received, in
+/// MyProfiler::Now seconds.
+struct MyMidiMessage
+{
+    enum Status
+    {
+        NOTE_OFF = 0x80,
+        NOTE_ON = 0x90,
+        CLOCK = 0xF8,
+        START = 0xFA,
+        CONTINUE = 0xFB,
+        STOP = 0xFC
+    };
+    
+    double time;
+    unsigned char status;
+    unsigned char data1;
+    unsigned char data2;
+};
+
+/// Turns a raw MIDI byte stream into messages. Handles running status and
+/// real time bytes in the middle of another message, skips sysex.
+class MyMidiParser
+{
+public:
+    MyMidiParser();
+    
+    /// True when byte completes a message, written to msg (time untouched).
+    bool Parse(const unsigned char& byte, MyMidiMessage& msg);
+    
+private:
+    unsigned char _status;
+    unsigned char _data[2];
+    int _count;
+    int _needed;
+};
+
+/// Reads raw MIDI from a file descriptor on its own thread: an ALSA rawmidi
+/// device (/dev/snd/midiC1D0, snd-virmidi gives loopback ones) or a named
+/// pipe. Each message is timestamped as it arrives and handed to the
+/// listener from the reader thread.
+class MyMidiInput
+{
+public:
+    class Listener
+    {
+    public:
+        virtual ~Listener()
+        {
+        }
+        
+        virtual void OnMidi(const MyMidiMessage& msg) = 0;
+    };
+    
+    MyMidiInput();
+    ~MyMidiInput();
+    
+    bool Open(const std::string& path, Listener* listener);
+    void Close();
+    
+    bool IsOpen() const
+    {
+        return _fd >= 0;
+    }
+    
+private:
+    void ReadLoop();
+    
+    int _fd;
+    Listener* _listener;
+    std::thread _thread;
+    std::atomic<bool> _quit;
+};
+
+#endif // __MY_MIDI_INPUT__
@@ -0,0 +1,110 @@
+#include "MyOfflineRenderer.h"
+#include <algorithm>
+#include <chrono>
+
+/*******************************************************************************
+ * MyOfflineRenderer.
+ ******************************************************************************/
+MyOfflineRenderer::MyOfflineRenderer(MySynthEngine* engine):
+_engine(engine),
+_profiler(nullptr),
+_frameCount(0),
+_renderTime(0.0)
+{
+    SetBlockSize(4096);
+}
+
+void MyOfflineRenderer::SetBlockSize(const int& frameCount)
+{
+    _buffer.resize(std::max(frameCount, 1) * 2);
+}
+
+void MyOfflineRenderer::SetProfiler(MyProfiler* profiler)
+{
+    _profiler = profiler;
+    _engine->SetProfiling(profiler != nullptr);
+    
+    if(_profiler != nullptr)
+    {
+        _profiler->SetSampleRate(_engine->GetSampleRate());
+    }
+}
+
+bool MyOfflineRenderer::Render(const std::string& path,
+                               const unsigned long& frameCount,
+                               const MyWavWriter::Format& format)
+{
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    
+    MyWavWriter wav;
+    
+    if(!wav.Open(path, _engine->GetSampleRate(), 2, format))
+    {
+        return false;
+    }
+    
+    const unsigned long blockSize = _buffer.size() / 2;
+    
+    _engine->Reset();
+    
+    for(unsigned long frame = 0; frame < frameCount; frame += blockSize)
+    {
+        const unsigned long n = std::min(blockSize, frameCount - frame);
+        ProcessBlock(_buffer.data(), n);
+        
+        if(!wav.Write(_buffer.data(), n))
+        {
+            return false;
+        }
+    }
+    
+    _frameCount = frameCount;
+    
+    bool ok = wav.Close();
+    
+    _renderTime = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    
+    return ok;
+}
+
+void MyOfflineRenderer::Render(float* output, const unsigned long& frameCount)
+{
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    
+    const unsigned long blockSize = _buffer.size() / 2;
+    
+    _engine->Reset();
+    
+    for(unsigned long frame = 0; frame < frameCount; frame += blockSize)
+    {
+        ProcessBlock(output + frame * 2,
+                     std::min(blockSize, frameCount - frame));
+    }
+    
+    _frameCount = frameCount;
+    _renderTime = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+void MyOfflineRenderer::ProcessBlock(float* output,
+                                     const unsigned long& frameCount)
+{
+    if(_profiler == nullptr)
+    {
+        _engine->Process(output, frameCount);
+        return;
+    }
+    
+    double stages[MyProfiler::NUM_STAGES];
+    
+    _profiler->BeginBlock();
+    _engine->Process(output, frameCount);
+    _engine->TakeStageTimes(stages);
+    _profiler->EndBlock(frameCount, stages);
+    
+    // Offline there's nobody else to drain the ring.
+    _profiler->Poll();
+}
@@ -0,0 +1,52 @@
+#ifndef __MY_OFFLINE_RENDERER__
+#define __MY_OFFLINE_RENDERER__
+
+#include <string>
+#include <vector>
+
+#include "MyProfiler.h"
+#include "MySynthEngine.h"
+#include "MyWavFile.h"
+
+/// Renders an engine to a WAV file as fast as the CPU allows, without any
+/// audio device or axApp window.
+class MyOfflineRenderer
+{
+public:
+    MyOfflineRenderer(MySynthEngine* engine);
+    
+    void SetBlockSize(const int& frameCount);
+    
+    /// Times every block as if it were an audio callback. Null to stop.
+    void SetProfiler(MyProfiler* profiler);
+    
+    /// Rewinds every line and renders frameCount frames.
+    bool Render(const std::string& path,
+                const unsigned long& frameCount,
+                const MyWavWriter::Format& format = MyWavWriter::PCM_16);
+    
+    /// Same into frameCount interleaved stereo frames of memory.
+    void Render(float* output, const unsigned long& frameCount);
+    
+    unsigned long GetFrameCount() const
+    {
+        return _frameCount;
+    }
+    
+    /// Wall clock time of the last render in seconds.
+    double GetRenderTime() const
+    {
+        return _renderTime;
+    }
+    
+private:
+    void ProcessBlock(float* output, const unsigned long& frameCount);
+    
+    MySynthEngine* _engine;
+    MyProfiler* _profiler;
+    std::vector<float> _buffer;
+    unsigned long _frameCount;
+    double _renderTime;
+};
+
+#endif // __MY_OFFLINE_RENDERER__
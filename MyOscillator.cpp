@@ -0,0 +1,165 @@
+#include "MyOscillator.h"
+#include <algorithm>
+#include <cmath>
+
+static const int SINE_TABLE_SIZE = 2048;
+
+// Built on first use whatever the static initialization order. The
+// oscillator constructor gets there first, never the audio thread.
+static const float* GetSineTable()
+{
+    struct Table
+    {
+        Table()
+        {
+            for(int i = 0; i <= SINE_TABLE_SIZE; i++)
+            {
+                values[i] = (float)sin(2.0 * M_PI * i / SINE_TABLE_SIZE);
+            }
+        }
+        
+        float values[SINE_TABLE_SIZE + 1];
+    };
+    
+    static const Table table;
+    return table.values;
+}
+
+// Polynomial approximation of the band-limited step residual, t is the
+// phase and dt the phase increment.
+static inline float PolyBlep(float t, const float& dt)
+{
+    if(t < dt)
+    {
+        t /= dt;
+        return t + t - t * t - 1.0f;
+    }
+    
+    if(t > 1.0f - dt)
+    {
+        t = (t - 1.0f) / dt;
+        return t * t + t + t + 1.0f;
+    }
+    
+    return 0.0f;
+}
+
+// Same for a slope discontinuity (integrated PolyBlep).
+static inline float PolyBlamp(float t, const float& dt)
+{
+    if(t < dt)
+    {
+        t = t / dt - 1.0f;
+        return -t * t * t / 3.0f;
+    }
+    
+    if(t > 1.0f - dt)
+    {
+        t = (t - 1.0f) / dt + 1.0f;
+        return t * t * t / 3.0f;
+    }
+    
+    return 0.0f;
+}
+
+static inline float Pulse(const float& phase, const float& dt,
+                          const float& width)
+{
+    float fall = phase + 1.0f - width;
+    fall -= fall >= 1.0f ? 1.0f : 0.0f;
+    
+    return (phase < width ? 1.0f : -1.0f) +
+           PolyBlep(phase, dt) - PolyBlep(fall, dt);
+}
+
+/*******************************************************************************
+ * MyOscillator.
+ ******************************************************************************/
+MyOscillator::MyOscillator():
+_sampleRate(44100.0),
+_waveform(SQUARE),
+_width(0.5f)
+{
+    GetSineTable();
+    Reset();
+}
+
+void MyOscillator::SetSampleRate(const double& sampleRate)
+{
+    _sampleRate = sampleRate;
+}
+
+void MyOscillator::SetWaveform(const Waveform& waveform)
+{
+    _waveform = waveform;
+}
+
+void MyOscillator::SetPulseWidth(const double& width)
+{
+    _width = (float)std::max(0.05, std::min(width, 0.95));
+}
+
+void MyOscillator::Reset()
+{
+    _phase = 0.0f;
+}
+
+void MyOscillator::ProcessBlock(float* output,
+                                const float* freq,
+                                const unsigned long& freqCount,
+                                const int& hold)
+{
+    const float invRate = (float)(1.0 / _sampleRate);
+    const float* sine = GetSineTable();
+    float phase = _phase;
+    
+    for(unsigned long i = 0; i < freqCount; i++)
+    {
+        // Kept below Nyquist so the BLEP regions never overlap.
+        const float dt = std::min(freq[i] * invRate, 0.45f);
+        float* out = output + i * hold;
+        
+        for(int j = 0; j < hold; j++)
+        {
+            switch(_waveform)
+            {
+                case SAW:
+                    out[j] = 2.0f * phase - 1.0f - PolyBlep(phase, dt);
+                    break;
+                
+                case SQUARE:
+                    out[j] = Pulse(phase, dt, 0.5f);
+                    break;
+                
+                case PULSE:
+                    out[j] = Pulse(phase, dt, _width);
+                    break;
+                
+                case TRIANGLE:
+                {
+                    // Corners at phase 0 (bottom) and 0.5 (top).
+                    float top = phase + 0.5f;
+                    top -= top >= 1.0f ? 1.0f : 0.0f;
+                    
+                    out[j] = 1.0f - 4.0f * fabsf(phase - 0.5f) +
+                             4.0f * dt * (PolyBlamp(phase, dt) -
+                                          PolyBlamp(top, dt));
+                    break;
+                }
+                
+                case SINE:
+                {
+                    const float p = phase * SINE_TABLE_SIZE;
+                    const int k = (int)p;
+                    out[j] = sine[k] + (p - k) * (sine[k + 1] - sine[k]);
+                    break;
+                }
+            }
+            
+            phase += dt;
+            phase -= phase >= 1.0f ? 1.0f : 0.0f;
+        }
+    }
+    
+    _phase = phase;
+}
@@ -0,0 +1,47 @@
+#ifndef __MY_OSCILLATOR__
+#define __MY_OSCILLATOR__
+
+/// Band-limited oscillator. Saw, square and pulse get a PolyBLEP correction
+/// at each discontinuity and the triangle a PolyBLAMP at each corner, so
+/// they stay clean up to the top of the note range without oversampling.
+/// The sine is read from a table.
+class MyOscillator
+{
+public:
+    MyOscillator();
+    
+    enum Waveform
+    {
+        SINE,
+        TRIANGLE,
+        SQUARE,
+        SAW,
+        PULSE
+    };
+    
+    /// Rate of the output samples, oversampling included.
+    void SetSampleRate(const double& sampleRate);
+    
+    void SetWaveform(const Waveform& waveform);
+    
+    /// Duty cycle of PULSE, from 0.05 to 0.95.
+    void SetPulseWidth(const double& width);
+    
+    void Reset();
+    
+    /// freq[i] is the frequency in Hz for the i-th group of hold output
+    /// samples, so a pitch path at the base rate can drive an oversampled
+    /// oscillator. Writes freqCount * hold samples.
+    void ProcessBlock(float* output,
+                      const float* freq,
+                      const unsigned long& freqCount,
+                      const int& hold = 1);
+                      
+private:
+    double _sampleRate;
+    Waveform _waveform;
+    float _width;
+    float _phase;
+};
+
+#endif // __MY_OSCILLATOR__
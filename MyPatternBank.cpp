@@ -0,0 +1,101 @@
+#include "MyPatternBank.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Out of line definitions, std::min takes them by reference.
+const int MyPatternBank::MAX_STEPS;
+const int MyPatternBank::STEPS_PER_BAR;
+const int MyPatternBank::NUM_PATTERNS;
+const int MyPatternBank::MAX_CHAIN;
+
+// Range of the cutoff lane, in octaves above 20 Hz.
+static const double CUTOFF_LANE_MIN = 20.0;
+static const double CUTOFF_LANE_OCTAVES = 9.97;
+
+/*******************************************************************************
+ * MyPatternBank.
+ ******************************************************************************/
+MyPatternBank::MyPatternBank():
+_chainLength(1)
+{
+    for(int p = 0; p < NUM_PATTERNS; p++)
+    {
+        _patterns[p].length = STEPS_PER_BAR;
+        
+        for(int i = 0; i < MAX_STEPS; i++)
+        {
+            Note& note = _patterns[p].notes[i];
+            note.on = true;
+            note.slide = false;
+            note.up = false;
+            note.down = false;
+            note.note = 0;
+            note.accent = false;
+        }
+        
+        ClearAutomation(_patterns[p].automation);
+    }
+    
+    std::fill(_chain, _chain + MAX_CHAIN, 0);
+}
+
+void MyPatternBank::SetLength(const int& pattern, const int& length)
+{
+    _patterns[pattern].length = std::max(1, std::min(length, MAX_STEPS));
+}
+
+void MyPatternBank::SetChainEntry(const int& index, const int& pattern)
+{
+    _chain[index] = std::max(0, std::min(pattern, NUM_PATTERNS - 1));
+}
+
+void MyPatternBank::SetChainLength(const int& length)
+{
+    _chainLength = std::max(1, std::min(length, MAX_CHAIN));
+}
+
+void MyPatternBank::SetAutomation(const int& pattern,
+                                  const int& step,
+                                  const int& lane,
+                                  const double& value)
+{
+    Automation& automation = _patterns[pattern].automation;
+    automation.values[lane][step] = EncodeLane(lane, value);
+    automation.mask[lane] |= 1ULL << step;
+}
+
+void MyPatternBank::ClearAutomation(const int& pattern)
+{
+    ClearAutomation(_patterns[pattern].automation);
+}
+
+void MyPatternBank::ClearAutomation(Automation& automation)
+{
+    memset(&automation, 0, sizeof(automation));
+}
+
+unsigned char MyPatternBank::EncodeLane(const int& lane, const double& value)
+{
+    double x = value;
+    
+    if(lane == CUTOFF)
+    {
+        x = log2(std::max(value, CUTOFF_LANE_MIN) / CUTOFF_LANE_MIN) /
+            CUTOFF_LANE_OCTAVES;
+    }
+    
+    return (unsigned char)lround(std::max(0.0, std::min(x, 1.0)) * 255.0);
+}
+
+double MyPatternBank::DecodeLane(const int& lane, const unsigned char& value)
+{
+    const double x = value / 255.0;
+    
+    if(lane == CUTOFF)
+    {
+        return CUTOFF_LANE_MIN * exp2(x * CUTOFF_LANE_OCTAVES);
+    }
+    
+    return x;
+}
@@ -0,0 +1,103 @@
+#ifndef __MY_PATTERN_BANK__
+#define __MY_PATTERN_BANK__
+
+/// Every pattern of a line, stored back to back in one flat array so
+/// playing a pattern is just holding a pointer into it, plus the song chain
+/// (the order patterns are played in song mode).
+class MyPatternBank
+{
+public:
+    MyPatternBank();
+    
+    /// slide glides from this step into the next one, which then doesn't
+    /// retrigger. accent makes the step louder and sweeps the cutoff up.
+    struct Note
+    {
+        bool slide, up, down, on, accent;
+        int note;
+    };
+    
+    static const int MAX_STEPS = 64;
+    static const int STEPS_PER_BAR = 16;
+    static const int NUM_PATTERNS = 64;
+    static const int MAX_CHAIN = 256;
+    
+    /// Knobs a pattern can sequence, one automation lane each.
+    enum Lane
+    {
+        CUTOFF,
+        RES,
+        ENV_MOD,
+        DECAY,
+        ACCENT,
+        NUM_LANES
+    };
+    
+    /// Knob values set by the steps, 8 bits each (see EncodeLane). A lane
+    /// only moves its knob on the steps whose bit is set in its mask, the
+    /// knob keeps that value until the next one.
+    struct Automation
+    {
+        unsigned long long mask[NUM_LANES];
+        unsigned char values[NUM_LANES][MAX_STEPS];
+    };
+    
+    struct Pattern
+    {
+        Note notes[MAX_STEPS];
+        int length;
+        Automation automation;
+    };
+    
+    Pattern* GetPattern(const int& index)
+    {
+        return &_patterns[index];
+    }
+    
+    const Pattern* GetPattern(const int& index) const
+    {
+        return &_patterns[index];
+    }
+    
+    /// From 1 to MAX_STEPS.
+    void SetLength(const int& pattern, const int& length);
+    
+    /// Knob value of lane at a step, in the knob's own unit.
+    void SetAutomation(const int& pattern,
+                       const int& step,
+                       const int& lane,
+                       const double& value);
+    
+    /// Every lane of the pattern.
+    void ClearAutomation(const int& pattern);
+    
+    static void ClearAutomation(Automation& automation);
+    
+    /// Cutoff in Hz is stored on an octave scale from 20 Hz to 20 kHz, the
+    /// other knobs go from 0 to 1.
+    static unsigned char EncodeLane(const int& lane, const double& value);
+    static double DecodeLane(const int& lane, const unsigned char& value);
+    
+    /// Pattern played at position index of the song.
+    void SetChainEntry(const int& index, const int& pattern);
+    
+    /// From 1 to MAX_CHAIN.
+    void SetChainLength(const int& length);
+    
+    int GetChainLength() const
+    {
+        return _chainLength;
+    }
+    
+    int GetChainEntry(const int& index) const
+    {
+        return _chain[index];
+    }
+    
+private:
+    Pattern _patterns[NUM_PATTERNS];
+    int _chain[MAX_CHAIN];
+    int _chainLength;
+};
+
+#endif // __MY_PATTERN_BANK__
@@ -0,0 +1,252 @@
+#include "MyPatternText.h"
+
+static inline bool IsSpace(const int& c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/*******************************************************************************
+ * MyPatternText.
+ ******************************************************************************/
+MyPatternText::MyPatternText():
+_file(nullptr),
+_line(0),
+_error(false),
+_bytesRead(0),
+_pos(0),
+_end(0)
+{
+
+}
+
+MyPatternText::~MyPatternText()
+{
+    Close();
+}
+
+bool MyPatternText::Open(const std::string& path)
+{
+    Close();
+    
+    _file = fopen(path.c_str(), "rb");
+    _line = 0;
+    _error = false;
+    _bytesRead = 0;
+    _pos = _end = 0;
+    
+    return _file != nullptr;
+}
+
+void MyPatternText::Close()
+{
+    if(_file != nullptr)
+    {
+        fclose(_file);
+        _file = nullptr;
+    }
+}
+
+int MyPatternText::NextChar()
+{
+    if(_pos == _end)
+    {
+        _end = _file == nullptr ? 0 : (int)fread(_buffer, 1, BUFFER_BYTES,
+                                                 _file);
+        _pos = 0;
+        _bytesRead += _end;
+        
+        if(_end == 0)
+        {
+            return EOF;
+        }
+    }
+    
+    return _buffer[_pos++];
+}
+
+bool MyPatternText::Read(MyPatternBank::Pattern& pattern)
+{
+    while(!_error)
+    {
+        // Gather one line, comments stripped.
+        int length = 0;
+        int c = NextChar();
+        bool comment = false;
+        
+        if(c == EOF)
+        {
+            return false;
+        }
+        
+        ++_line;
+        
+        for(; c != EOF && c != '\n'; c = NextChar())
+        {
+            comment = comment || c == '#';
+            
+            if(comment)
+            {
+                continue;
+            }
+            
+            if(length == MAX_LINE - 1)
+            {
+                _error = true;
+                return false;
+            }
+            
+            _lineBuffer[length++] = (char)c;
+        }
+        
+        _lineBuffer[length] = '\0';
+        
+        // Blank lines don't count as patterns.
+        int i = 0;
+        while(IsSpace(_lineBuffer[i]))
+        {
+            ++i;
+        }
+        
+        if(_lineBuffer[i] == '\0')
+        {
+            continue;
+        }
+        
+        if(!Parse(_lineBuffer, pattern))
+        {
+            _error = true;
+            return false;
+        }
+        
+        return true;
+    }
+    
+    return false;
+}
+
+bool MyPatternText::Parse(const char* text, MyPatternBank::Pattern& pattern)
+{
+    const char* p = text;
+    int count = 0;
+    
+    while(true)
+    {
+        while(IsSpace(*p))
+        {
+            ++p;
+        }
+        
+        if(*p == '\0' || *p == '\n')
+        {
+            break;
+        }
+        
+        if(count == MyPatternBank::MAX_STEPS)
+        {
+            return false;
+        }
+        
+        MyPatternBank::Note& note = pattern.notes[count++];
+        note.on = true;
+        note.up = note.down = note.accent = note.slide = false;
+        note.note = 0;
+        
+        if(*p == '-')
+        {
+            note.on = false;
+            ++p;
+        }
+        
+        if(*p >= '0' && *p <= '9')
+        {
+            for(; *p >= '0' && *p <= '9'; ++p)
+            {
+                note.note = note.note * 10 + (*p - '0');
+                
+                if(note.note > 12)
+                {
+                    return false;
+                }
+            }
+        }
+        else if(note.on)
+        {
+            return false;
+        }
+        
+        for(; *p != '\0' && *p != '\n' && !IsSpace(*p); ++p)
+        {
+            switch(*p)
+            {
+                case 'u': note.up = true; break;
+                case 'd': note.down = true; break;
+                case 'a': note.accent = true; break;
+                case 's': note.slide = true; break;
+                default: return false;
+            }
+        }
+    }
+    
+    pattern.length = count;
+    return count > 0;
+}
+
+bool MyPatternText::Write(FILE* file, const MyPatternBank::Pattern& pattern)
+{
+    for(int i = 0; i < pattern.length; i++)
+    {
+        const MyPatternBank::Note& note = pattern.notes[i];
+        char token[16];
+        int n = 0;
+        
+        if(i > 0)
+        {
+            token[n++] = ' ';
+        }
+        
+        if(!note.on)
+        {
+            token[n++] = '-';
+        }
+        
+        // A bare - is a rest on C, the note is only written when it matters.
+        if(note.on || note.note != 0 || note.up || note.down || note.accent ||
+           note.slide)
+        {
+            n += snprintf(token + n, sizeof(token) - n, "%d", note.note);
+        }
+        
+        if(note.up) token[n++] = 'u';
+        if(note.down) token[n++] = 'd';
+        if(note.accent) token[n++] = 'a';
+        if(note.slide) token[n++] = 's';
+        
+        if(fwrite(token, 1, n, file) != (size_t)n)
+        {
+            return false;
+        }
+    }
+    
+    return fputc('\n', file) != EOF;
+}
+
+bool MyPatternText::Save(const std::string& path,
+                         const MyPatternBank::Pattern* patterns,
+                         const int& count)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    
+    if(file == nullptr)
+    {
+        return false;
+    }
+    
+    bool ok = true;
+    
+    for(int i = 0; i < count && ok; i++)
+    {
+        ok = Write(file, patterns[i]);
+    }
+    
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,75 @@
+#ifndef __MY_PATTERN_TEXT__
+#define __MY_PATTERN_TEXT__
+
+#include <cstdio>
+#include <string>
+
+#include "MyPatternBank.h"
+
+/// Plain text patterns, one pattern per line, one token per step :
+///
+///     # Comment until the end of the line.
+///     0 3a 7s 12us -  -5d 3 0a
+///
+/// A step is the semitone above C (0 to 12) followed by any of u (octave
+/// up), d (octave down), a (accent) and s (slide). A leading - turns the
+/// step off, alone it is a rest on C without flags. 1 to 64 steps per line,
+/// blank lines are ignored.
+///
+/// Reading streams the file through a fixed buffer, nothing is allocated
+/// per pattern, so directories of thousands of files load at disk speed.
+class MyPatternText
+{
+public:
+    MyPatternText();
+    ~MyPatternText();
+    
+    bool Open(const std::string& path);
+    void Close();
+    
+    /// Next pattern of the file. false at the end or on a syntax error.
+    bool Read(MyPatternBank::Pattern& pattern);
+    
+    bool HasError() const
+    {
+        return _error;
+    }
+    
+    /// Line of the last pattern read, or of the error.
+    int GetLine() const
+    {
+        return _line;
+    }
+    
+    unsigned long GetBytesRead() const
+    {
+        return _bytesRead;
+    }
+    
+    /// One line of tokens, see above.
+    static bool Parse(const char* text, MyPatternBank::Pattern& pattern);
+    
+    /// One pattern as a line of tokens.
+    static bool Write(FILE* file, const MyPatternBank::Pattern& pattern);
+    
+    static bool Save(const std::string& path,
+                     const MyPatternBank::Pattern* patterns,
+                     const int& count);
+                     
+private:
+    int NextChar();
+    
+    FILE* _file;
+    int _line;
+    bool _error;
+    unsigned long _bytesRead;
+    
+    static const int BUFFER_BYTES = 1 << 16;
+    static const int MAX_LINE = 1024;
+    unsigned char _buffer[BUFFER_BYTES];
+    int _pos;
+    int _end;
+    char _lineBuffer[MAX_LINE];
+};
+
+#endif // __MY_PATTERN_TEXT__
@@ -0,0 +1,48 @@
+#include "MyPitchTable.h"
+#include <algorithm>
+#include <cmath>
+
+/*******************************************************************************
+ * MyPitchTable.
+ ******************************************************************************/
+MyPitchTable::MyPitchTable():
+_baseFreq(110.0),
+_tuning(1.0)
+{
+    SetScale(nullptr);
+}
+
+void MyPitchTable::SetBaseFreq(const double& freq)
+{
+    _baseFreq = freq;
+    Build();
+}
+
+void MyPitchTable::SetTuning(const double& tune)
+{
+    _tuning = std::max(0.5, std::min(tune, 2.0));
+    Build();
+}
+
+void MyPitchTable::SetScale(const double* cents)
+{
+    for(int i = 0; i < 12; i++)
+    {
+        _cents[i] = cents == nullptr ? 0.0 : cents[i];
+    }
+    
+    Build();
+}
+
+void MyPitchTable::Build()
+{
+    for(int i = 0; i < NUM_NOTES; i++)
+    {
+        const int note = i + MIN_NOTE;
+        const int pitchClass = ((note % 12) + 12) % 12;
+        
+        _freq[i] = static_cast<float>(_baseFreq * _tuning *
+                                      pow(2.0, note / 12.0 +
+                                          _cents[pitchClass] / 1200.0));
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef __MY_PITCH_TABLE__
+#define __MY_PITCH_TABLE__
+
+/// Semitone to frequency table covering every note a step can play, from
+/// C0 one octave down to C1 one octave up. Built once per tuning change so
+/// the audio thread never calls pow().
+///
+/// Pitches are semitones above the base C0 and can be fractional : GetFreq
+/// interpolates between the two neighbouring entries, which is what the
+/// slide reads every sample.
+class MyPitchTable
+{
+public:
+    MyPitchTable();
+    
+    static const int MIN_NOTE = -12;
+    static const int MAX_NOTE = 24;
+    static const int NUM_NOTES = MAX_NOTE - MIN_NOTE + 1;
+    
+    /// Frequency of note 0 before tuning.
+    void SetBaseFreq(const double& freq);
+    
+    /// Fine tuning ratio from 0.5 to 2.
+    void SetTuning(const double& tune);
+    
+    double GetTuning() const
+    {
+        return _tuning;
+    }
+    
+    /// Alternative tuning : offset in cents of each of the 12 pitch classes
+    /// from equal temperament. nullptr goes back to equal temperament.
+    void SetScale(const double* cents);
+    
+    float GetFreq(const int& note) const
+    {
+        return _freq[note - MIN_NOTE];
+    }
+    
+    float GetFreq(const float& pitch) const
+    {
+        float p = pitch - MIN_NOTE;
+        p = p < 0.0f ? 0.0f : (p > NUM_NOTES - 1 ? NUM_NOTES - 1 : p);
+        
+        int i = static_cast<int>(p);
+        i = i < NUM_NOTES - 1 ? i : NUM_NOTES - 2;
+        
+        const float frac = p - i;
+        return _freq[i] + frac * (_freq[i + 1] - _freq[i]);
+    }
+    
+private:
+    void Build();
+    
+    double _baseFreq;
+    double _tuning;
+    double _cents[12];
+    float _freq[NUM_NOTES];
+};
+
+#endif // __MY_PITCH_TABLE__
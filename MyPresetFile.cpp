@@ -0,0 +1,306 @@
+#include "MyPresetFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const int HEADER_BYTES = 16;
+static const int NUM_KNOBS = 9;
+static const int RECORD_V1_BYTES = NUM_KNOBS * 4 + 4 +
+                                   MyPatternBank::MAX_STEPS * 2;
+static const int AUTOMATION_BYTES = MyPatternBank::NUM_LANES *
+                                    (8 + MyPatternBank::MAX_STEPS);
+static const int RECORD_BYTES = RECORD_V1_BYTES + AUTOMATION_BYTES;
+
+static void PutLE16(unsigned char* p, const unsigned int& v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void PutLE32(unsigned char* p, const unsigned int& v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static unsigned int GetLE16(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static unsigned int GetLE32(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+static void PutFloat(unsigned char* p, const double& v)
+{
+    float f = (float)v;
+    unsigned int bits;
+    memcpy(&bits, &f, 4);
+    PutLE32(p, bits);
+}
+
+static double GetFloat(const unsigned char* p)
+{
+    unsigned int bits = GetLE32(p);
+    float f;
+    memcpy(&f, &bits, 4);
+    return f;
+}
+
+static unsigned int PackNote(const MyPatternBank::Note& note)
+{
+    return (note.note & 0x0F) |
+           (note.on ? 0x10 : 0) |
+           (note.up ? 0x20 : 0) |
+           (note.down ? 0x40 : 0) |
+           (note.accent ? 0x80 : 0) |
+           (note.slide ? 0x100 : 0);
+}
+
+static void UnpackNote(const unsigned int& bits, MyPatternBank::Note& note)
+{
+    note.note = std::min<int>(bits & 0x0F, 12);
+    note.on = (bits & 0x10) != 0;
+    note.up = (bits & 0x20) != 0;
+    note.down = (bits & 0x40) != 0;
+    note.accent = (bits & 0x80) != 0;
+    note.slide = (bits & 0x100) != 0;
+}
+
+/*******************************************************************************
+ * MyPreset.
+ ******************************************************************************/
+MyPreset::MyPreset():
+tuning(1.0),
+cutoff(20000.0),
+res(0.0),
+envMod(0.5),
+decay(0.5),
+accent(0.5),
+volume(0.0),
+bpm(120.0),
+pulseWidth(0.5),
+waveform(MyOscillator::SQUARE)
+{
+    // Same default pattern as a new bank.
+    pattern.length = MyPatternBank::STEPS_PER_BAR;
+    
+    for(int i = 0; i < MyPatternBank::MAX_STEPS; i++)
+    {
+        MyPatternBank::Note& note = pattern.notes[i];
+        note.on = true;
+        note.slide = false;
+        note.up = false;
+        note.down = false;
+        note.note = 0;
+        note.accent = false;
+    }
+    
+    MyPatternBank::ClearAutomation(pattern.automation);
+}
+
+/*******************************************************************************
+ * MyPresetFile.
+ ******************************************************************************/
+MyPresetFile::MyPresetFile():
+_data(nullptr),
+_size(0),
+_recordSize(RECORD_BYTES),
+_numPresets(0)
+{
+
+}
+
+MyPresetFile::~MyPresetFile()
+{
+    Close();
+}
+
+bool MyPresetFile::Open(const std::string& path)
+{
+    Close();
+    
+    int fd = open(path.c_str(), O_RDONLY);
+    
+    if(fd < 0)
+    {
+        return false;
+    }
+    
+    struct stat st;
+    
+    if(fstat(fd, &st) != 0 || st.st_size < HEADER_BYTES)
+    {
+        close(fd);
+        return false;
+    }
+    
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    
+    // The mapping stays valid once the descriptor is closed.
+    close(fd);
+    
+    if(data == MAP_FAILED)
+    {
+        return false;
+    }
+    
+    _data = static_cast<const unsigned char*>(data);
+    _size = st.st_size;
+    
+    const int version = GetLE16(_data + 4);
+    _recordSize = GetLE16(_data + 6);
+    const unsigned long count = GetLE32(_data + 8);
+    
+    if(memcmp(_data, "303P", 4) != 0 || version < 1 ||
+       _recordSize < RECORD_V1_BYTES ||
+       HEADER_BYTES + count * _recordSize > _size)
+    {
+        Close();
+        return false;
+    }
+    
+    _numPresets = static_cast<int>(count);
+    return true;
+}
+
+void MyPresetFile::Close()
+{
+    if(_data != nullptr)
+    {
+        munmap(const_cast<unsigned char*>(_data), _size);
+    }
+    
+    _data = nullptr;
+    _size = 0;
+    _numPresets = 0;
+}
+
+bool MyPresetFile::Read(const int& index, MyPreset& preset) const
+{
+    if(index < 0 || index >= _numPresets)
+    {
+        return false;
+    }
+    
+    const unsigned char* p = _data + HEADER_BYTES + (size_t)index * _recordSize;
+    
+    preset.tuning = GetFloat(p);
+    preset.cutoff = GetFloat(p + 4);
+    preset.res = GetFloat(p + 8);
+    preset.envMod = GetFloat(p + 12);
+    preset.decay = GetFloat(p + 16);
+    preset.accent = GetFloat(p + 20);
+    preset.volume = GetFloat(p + 24);
+    preset.bpm = GetFloat(p + 28);
+    preset.pulseWidth = GetFloat(p + 32);
+    
+    p += NUM_KNOBS * 4;
+    preset.waveform = static_cast<MyOscillator::Waveform>(
+        std::min<int>(p[0], MyOscillator::PULSE));
+    preset.pattern.length = std::max(1, std::min<int>(p[1],
+                                                      MyPatternBank::MAX_STEPS));
+    
+    p += 4;
+    
+    for(int i = 0; i < MyPatternBank::MAX_STEPS; i++)
+    {
+        UnpackNote(GetLE16(p + i * 2), preset.pattern.notes[i]);
+    }
+    
+    MyPatternBank::Automation& automation = preset.pattern.automation;
+    
+    // Version 1 records end before the automation.
+    if(_recordSize < RECORD_BYTES)
+    {
+        MyPatternBank::ClearAutomation(automation);
+        return true;
+    }
+    
+    p += MyPatternBank::MAX_STEPS * 2;
+    
+    for(int lane = 0; lane < MyPatternBank::NUM_LANES; lane++)
+    {
+        const unsigned long long low = GetLE32(p + lane * 8);
+        const unsigned long long high = GetLE32(p + lane * 8 + 4);
+        automation.mask[lane] = low | high << 32;
+    }
+    
+    p += MyPatternBank::NUM_LANES * 8;
+    memcpy(automation.values, p, sizeof(automation.values));
+    
+    return true;
+}
+
+bool MyPresetFile::Save(const std::string& path,
+                        const MyPreset* presets,
+                        const int& count)
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    
+    if(file == nullptr)
+    {
+        return false;
+    }
+    
+    unsigned char header[HEADER_BYTES] = { 0 };
+    memcpy(header, "303P", 4);
+    PutLE16(header + 4, VERSION);
+    PutLE16(header + 6, RECORD_BYTES);
+    PutLE32(header + 8, count);
+    
+    bool ok = fwrite(header, 1, HEADER_BYTES, file) == HEADER_BYTES;
+    
+    for(int i = 0; i < count && ok; i++)
+    {
+        const MyPreset& preset = presets[i];
+        unsigned char record[RECORD_BYTES] = { 0 };
+        unsigned char* p = record;
+        
+        PutFloat(p, preset.tuning);
+        PutFloat(p + 4, preset.cutoff);
+        PutFloat(p + 8, preset.res);
+        PutFloat(p + 12, preset.envMod);
+        PutFloat(p + 16, preset.decay);
+        PutFloat(p + 20, preset.accent);
+        PutFloat(p + 24, preset.volume);
+        PutFloat(p + 28, preset.bpm);
+        PutFloat(p + 32, preset.pulseWidth);
+        
+        p += NUM_KNOBS * 4;
+        p[0] = static_cast<unsigned char>(preset.waveform);
+        p[1] = static_cast<unsigned char>(preset.pattern.length);
+        
+        p += 4;
+        
+        for(int s = 0; s < MyPatternBank::MAX_STEPS; s++)
+        {
+            PutLE16(p + s * 2, PackNote(preset.pattern.notes[s]));
+        }
+        
+        const MyPatternBank::Automation& automation = preset.pattern.automation;
+        p += MyPatternBank::MAX_STEPS * 2;
+        
+        for(int lane = 0; lane < MyPatternBank::NUM_LANES; lane++)
+        {
+            PutLE32(p + lane * 8, automation.mask[lane] & 0xFFFFFFFF);
+            PutLE32(p + lane * 8 + 4, automation.mask[lane] >> 32);
+        }
+        
+        p += MyPatternBank::NUM_LANES * 8;
+        memcpy(p, automation.values, sizeof(automation.values));
+        
+        ok = fwrite(record, 1, RECORD_BYTES, file) == RECORD_BYTES;
+    }
+    
+    return fclose(file) == 0 && ok;
+}
@@ -0,0 +1,71 @@
+#ifndef __MY_PRESET_FILE__
+#define __MY_PRESET_FILE__
+
+#include <cstddef>
+#include <string>
+
+#include "MyOscillator.h"
+#include "MyPatternBank.h"
+
+/// Knob settings and one pattern, the unit of a preset library.
+struct MyPreset
+{
+    MyPreset();
+    
+    double tuning;
+    double cutoff; // Hz.
+    double res;
+    double envMod;
+    double decay;
+    double accent;
+    double volume;
+    double bpm;
+    double pulseWidth;
+    MyOscillator::Waveform waveform;
+    MyPatternBank::Pattern pattern;
+};
+
+/// Preset library on disk : a small header followed by fixed size records,
+/// one per preset, with the steps bit packed in 16 bits each. The file is
+/// mapped read only, so opening a library of thousands of presets costs
+/// nothing and reading one is unpacking a single record in place.
+///
+/// Layout, little endian :
+///   header  "303P", u16 version, u16 record size, u32 count, u32 reserved
+///   record  9 x f32 knobs, u8 waveform, u8 length, u16 reserved,
+///           64 x u16 steps (bits 0-3 note, then on, up, down, accent, slide)
+///           version 2 : 5 x u64 automation step masks, then 5 x 64 u8
+///           automation values (see MyPatternBank::Automation)
+///
+/// Readers skip fields a newer version appends to the record.
+class MyPresetFile
+{
+public:
+    MyPresetFile();
+    ~MyPresetFile();
+    
+    static const int VERSION = 2;
+    
+    bool Open(const std::string& path);
+    void Close();
+    
+    int GetNumPresets() const
+    {
+        return _numPresets;
+    }
+    
+    /// No allocation, safe to call for every preset change.
+    bool Read(const int& index, MyPreset& preset) const;
+    
+    static bool Save(const std::string& path,
+                     const MyPreset* presets,
+                     const int& count);
+                     
+private:
+    const unsigned char* _data;
+    size_t _size;
+    int _recordSize;
+    int _numPresets;
+};
+
+#endif // __MY_PRESET_FILE__
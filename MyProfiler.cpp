@@ -0,0 +1,151 @@
+#include "MyProfiler.h"
+#include <algorithm>
+
+/*******************************************************************************
+ * MyProfiler.
+ ******************************************************************************/
+MyProfiler::MyProfiler():
+_blocks(new MyLockFreeQueue<Block, 1024>()),
+_xruns(0),
+_dropped(0),
+_origin(Now()),
+_sampleRate(44100.0),
+_blockStart(0.0),
+_lastStart(-1.0),
+_lastPeriod(0.0),
+_windowPos(0),
+_export(nullptr)
+{
+    _last = Block();
+    std::fill(_window, _window + WINDOW_BLOCKS, 0.0f);
+}
+
+MyProfiler::~MyProfiler()
+{
+    StopExport();
+    delete _blocks;
+}
+
+void MyProfiler::Reset()
+{
+    Block block;
+    
+    while(_blocks->Pop(block))
+    {
+    }
+    
+    _xruns.store(0, std::memory_order_relaxed);
+    _dropped.store(0, std::memory_order_relaxed);
+    _lastStart = -1.0;
+    _lastPeriod = 0.0;
+    
+    _last = Block();
+    std::fill(_window, _window + WINDOW_BLOCKS, 0.0f);
+    _windowPos = 0;
+}
+
+void MyProfiler::SetSampleRate(const double& sampleRate)
+{
+    _sampleRate = sampleRate;
+    
+    // The gap to the next block means nothing across a rate change.
+    _lastStart = -1.0;
+}
+
+void MyProfiler::BeginBlock()
+{
+    _blockStart = Now();
+}
+
+void MyProfiler::EndBlock(const unsigned long& frameCount,
+                          const double* stages)
+{
+    const double end = Now();
+    const double period = frameCount / _sampleRate;
+    
+    Block block;
+    block.start = _blockStart - _origin;
+    block.frames = (unsigned int)frameCount;
+    block.duration = (float)(end - _blockStart);
+    block.load = period > 0.0 ? (float)((end - _blockStart) / period) : 0.0f;
+    
+    for(int i = 0; i < NUM_STAGES; i++)
+    {
+        block.stages[i] = stages == nullptr ? 0.0f : (float)stages[i];
+    }
+    
+    block.xrun = block.load > 1.0f ||
+                 (_lastStart >= 0.0 &&
+                  _blockStart - _lastStart > 1.5 * _lastPeriod);
+    
+    _lastStart = _blockStart;
+    _lastPeriod = period;
+    
+    if(block.xrun)
+    {
+        _xruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    if(!_blocks->Push(block))
+    {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+int MyProfiler::Poll()
+{
+    int count = 0;
+    Block block;
+    
+    while(_blocks->Pop(block))
+    {
+        _last = block;
+        _window[_windowPos] = block.load;
+        _windowPos = (_windowPos + 1) % WINDOW_BLOCKS;
+        ++count;
+        
+        if(_export != nullptr)
+        {
+            fprintf(_export, "%.6f,%u,%.3f,%.4f,%.3f,%.3f,%.3f,%.3f,%d\n",
+                    block.start, block.frames, block.duration * 1e6,
+                    block.load,
+                    block.stages[OSCILLATOR] * 1e6,
+                    block.stages[FILTER] * 1e6,
+                    block.stages[DECIMATOR] * 1e6,
+                    block.stages[ENVELOPE] * 1e6,
+                    block.xrun ? 1 : 0);
+        }
+    }
+    
+    return count;
+}
+
+float MyProfiler::GetWorstLoad() const
+{
+    return *std::max_element(_window, _window + WINDOW_BLOCKS);
+}
+
+bool MyProfiler::StartExport(const std::string& path)
+{
+    StopExport();
+    
+    _export = fopen(path.c_str(), "w");
+    
+    if(_export == nullptr)
+    {
+        return false;
+    }
+    
+    fprintf(_export, "start_s,frames,callback_us,load,oscillator_us,"
+                     "filter_us,decimator_us,envelope_us,xrun\n");
+    return true;
+}
+
+void MyProfiler::StopExport()
+{
+    if(_export != nullptr)
+    {
+        fclose(_export);
+        _export = nullptr;
+    }
+}
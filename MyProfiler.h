@@ -0,0 +1,114 @@
+#ifndef __MY_PROFILER__
+#define __MY_PROFILER__
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "MyLockFreeQueue.h"
+
+/// Per block timing of the audio callback.
+///
+/// The audio thread brackets each block with BeginBlock / EndBlock, which
+/// only read the clock and push one Block into a lock free ring. The GUI
+/// thread drains the ring with Poll, keeps the running statistics and
+/// optionally appends every block to a CSV file.
+///
+/// There is no xrun flag in the callback, a block counts as an xrun when it
+/// took longer than its own duration or started more than one and a half
+/// buffer periods after the previous one.
+class MyProfiler
+{
+public:
+    MyProfiler();
+    ~MyProfiler();
+    
+    enum Stage
+    {
+        OSCILLATOR,
+        FILTER,
+        DECIMATOR,
+        ENVELOPE,
+        NUM_STAGES
+    };
+    
+    struct Block
+    {
+        double start; // Seconds since the profiler was created.
+        unsigned int frames;
+        float duration; // Callback time in seconds.
+        float load; // duration / buffer period.
+        float stages[NUM_STAGES]; // Seconds, summed over every line.
+        bool xrun;
+    };
+    
+    static double Now()
+    {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    /// Clears the statistics and forgets the last block, so the first block
+    /// of a new run isn't taken for an xrun. Only while no block is being
+    /// timed, e.g. before the stream starts.
+    void Reset();
+    
+    /// Audio thread.
+    void SetSampleRate(const double& sampleRate);
+    void BeginBlock();
+    void EndBlock(const unsigned long& frameCount, const double* stages);
+    
+    /// GUI thread, takes the blocks recorded since the last call.
+    /// Returns how many.
+    int Poll();
+    
+    /// Of the last block polled.
+    const Block& GetLastBlock() const
+    {
+        return _last;
+    }
+    
+    /// Highest load of the last WINDOW_BLOCKS blocks.
+    float GetWorstLoad() const;
+    
+    unsigned long GetXrunCount() const
+    {
+        return _xruns.load(std::memory_order_relaxed);
+    }
+    
+    /// Blocks lost because the GUI didn't poll fast enough.
+    unsigned long GetDroppedCount() const
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+    
+    /// Every polled block is appended to path as CSV.
+    bool StartExport(const std::string& path);
+    void StopExport();
+    
+    static const int WINDOW_BLOCKS = 256;
+    
+private:
+    MyProfiler(const MyProfiler&);
+    MyProfiler& operator=(const MyProfiler&);
+    
+    MyLockFreeQueue<Block, 1024>* _blocks;
+    std::atomic<unsigned long> _xruns;
+    std::atomic<unsigned long> _dropped;
+    
+    // Audio thread state.
+    double _origin;
+    double _sampleRate;
+    double _blockStart;
+    double _lastStart;
+    double _lastPeriod;
+    
+    // GUI thread state.
+    Block _last;
+    float _window[WINDOW_BLOCKS];
+    int _windowPos;
+    FILE* _export;
+};
+
+#endif // __MY_PROFILER__
@@ -0,0 +1,261 @@
+#include "MyRealtimeCheck.h"
+
+#ifdef MY_RT_CHECK
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <execinfo.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <dlfcn.h>
+#endif
+
+// The tag lives in a pthread key rather than a thread_local : the first
+// access to a thread_local can allocate, which would recurse into malloc.
+static pthread_key_t TAG_KEY;
+static const bool TAG_KEY_OK = pthread_key_create(&TAG_KEY, nullptr) == 0;
+
+static std::atomic<unsigned long> VIOLATIONS(0);
+static std::atomic<bool> ABORT_ON_VIOLATION(false);
+
+static inline bool GetTag()
+{
+    return TAG_KEY_OK && pthread_getspecific(TAG_KEY) != nullptr;
+}
+
+static inline void SetTag(const bool& tag)
+{
+    if(TAG_KEY_OK)
+    {
+        pthread_setspecific(TAG_KEY, tag ? (void*)1 : nullptr);
+    }
+}
+
+/*******************************************************************************
+ * MyRealtimeCheck.
+ ******************************************************************************/
+MyRealtimeCheck::Scope::Scope():
+_previous(GetTag())
+{
+    SetTag(true);
+}
+
+MyRealtimeCheck::Scope::~Scope()
+{
+    SetTag(_previous);
+}
+
+bool MyRealtimeCheck::IsRealtimeThread()
+{
+    return GetTag();
+}
+
+unsigned long MyRealtimeCheck::GetViolationCount()
+{
+    return VIOLATIONS.load();
+}
+
+void MyRealtimeCheck::SetAbortOnViolation(const bool& abort)
+{
+    ABORT_ON_VIOLATION = abort;
+}
+
+void MyRealtimeCheck::Check(const char* what)
+{
+    if(!GetTag())
+    {
+        return;
+    }
+    
+    // Untagged while reporting, printing does everything we complain about.
+    SetTag(false);
+    
+    ++VIOLATIONS;
+    fprintf(stderr, "MyRealtimeCheck : %s on the audio thread\n", what);
+    
+    void* stack[32];
+    int depth = backtrace(stack, 32);
+    backtrace_symbols_fd(stack, depth, STDERR_FILENO);
+    
+    if(ABORT_ON_VIOLATION)
+    {
+        abort();
+    }
+    
+    SetTag(true);
+}
+
+/*******************************************************************************
+ * Interposed functions.
+ ******************************************************************************/
+#ifdef __linux__
+extern "C"
+{
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void __libc_free(void* ptr);
+}
+
+static inline void* RawMalloc(size_t size)
+{
+    return __libc_malloc(size);
+}
+
+static inline void RawFree(void* ptr)
+{
+    __libc_free(ptr);
+}
+
+// Looked up on first use. No function static, its guard could lock.
+template<typename T>
+static T GetNext(T& fn, const char* name)
+{
+    if(fn == nullptr)
+    {
+        fn = reinterpret_cast<T>(dlsym(RTLD_NEXT, name));
+    }
+    
+    return fn;
+}
+
+extern "C"
+{
+    void* malloc(size_t size)
+    {
+        MyRealtimeCheck::Check("malloc");
+        return __libc_malloc(size);
+    }
+    
+    void* calloc(size_t count, size_t size)
+    {
+        MyRealtimeCheck::Check("calloc");
+        return __libc_calloc(count, size);
+    }
+    
+    void* realloc(void* ptr, size_t size)
+    {
+        MyRealtimeCheck::Check("realloc");
+        return __libc_realloc(ptr, size);
+    }
+    
+    void free(void* ptr)
+    {
+        if(ptr != nullptr)
+        {
+            MyRealtimeCheck::Check("free");
+        }
+        
+        __libc_free(ptr);
+    }
+    
+    int pthread_mutex_lock(pthread_mutex_t* mutex)
+    {
+        typedef int (*Fn)(pthread_mutex_t*);
+        static Fn next = nullptr;
+        
+        MyRealtimeCheck::Check("pthread_mutex_lock");
+        return GetNext(next, "pthread_mutex_lock")(mutex);
+    }
+    
+    int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex)
+    {
+        typedef int (*Fn)(pthread_cond_t*, pthread_mutex_t*);
+        static Fn next = nullptr;
+        
+        MyRealtimeCheck::Check("pthread_cond_wait");
+        return GetNext(next, "pthread_cond_wait")(cond, mutex);
+    }
+    
+    ssize_t read(int fd, void* buffer, size_t size)
+    {
+        typedef ssize_t (*Fn)(int, void*, size_t);
+        static Fn next = nullptr;
+        
+        MyRealtimeCheck::Check("read");
+        return GetNext(next, "read")(fd, buffer, size);
+    }
+    
+    ssize_t write(int fd, const void* buffer, size_t size)
+    {
+        typedef ssize_t (*Fn)(int, const void*, size_t);
+        static Fn next = nullptr;
+        
+        MyRealtimeCheck::Check("write");
+        return GetNext(next, "write")(fd, buffer, size);
+    }
+}
+#else
+// Elsewhere only operator new and delete are checked.
+static inline void* RawMalloc(size_t size)
+{
+    return malloc(size);
+}
+
+static inline void RawFree(void* ptr)
+{
+    free(ptr);
+}
+#endif
+
+void* operator new(size_t size)
+{
+    MyRealtimeCheck::Check("operator new");
+    void* ptr = RawMalloc(size == 0 ? 1 : size);
+    
+    if(ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    MyRealtimeCheck::Check("operator new");
+    return RawMalloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& nt) noexcept
+{
+    return operator new(size, nt);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    if(ptr != nullptr)
+    {
+        MyRealtimeCheck::Check("operator delete");
+    }
+    
+    RawFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+#endif // MY_RT_CHECK
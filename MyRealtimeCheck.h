@@ -0,0 +1,65 @@
+#ifndef __MY_REALTIME_CHECK__
+#define __MY_REALTIME_CHECK__
+
+// On by default in debug builds, MY_NO_RT_CHECK turns it off.
+#if !defined(NDEBUG) && !defined(MY_NO_RT_CHECK) && !defined(MY_RT_CHECK)
+#define MY_RT_CHECK 1
+#endif
+
+/// Debug check that the audio path never allocates, locks or does I/O.
+///
+/// Threads rendering audio are tagged with a Scope. With MY_RT_CHECK,
+/// operator new and delete are replaced, and on Linux malloc, calloc,
+/// realloc, free, pthread_mutex_lock, pthread_cond_wait, read and write are
+/// interposed too. Any of them called from a tagged thread is counted and
+/// its call stack printed on stderr. Without MY_RT_CHECK everything here
+/// compiles to nothing.
+class MyRealtimeCheck
+{
+public:
+    /// Tags the calling thread as real time for its lifetime, nests.
+    class Scope
+    {
+    public:
+#ifdef MY_RT_CHECK
+        Scope();
+        ~Scope();
+    
+    private:
+        bool _previous;
+#else
+        Scope()
+        {
+        }
+#endif
+    };
+
+#ifdef MY_RT_CHECK
+    static bool IsRealtimeThread();
+    
+    /// Violations since the start of the program.
+    static unsigned long GetViolationCount();
+    
+    /// Aborts at the first violation, for running under a debugger.
+    static void SetAbortOnViolation(const bool& abort);
+    
+    /// Called by the interposed functions.
+    static void Check(const char* what);
+#else
+    static bool IsRealtimeThread()
+    {
+        return false;
+    }
+    
+    static unsigned long GetViolationCount()
+    {
+        return 0;
+    }
+    
+    static void SetAbortOnViolation(const bool&)
+    {
+    }
+#endif
+};
+
+#endif // __MY_REALTIME_CHECK__
@@ -0,0 +1,69 @@
+#include "MyResources.h"
+#include <chrono>
+
+static double Now()
+{
+    return std::chrono::duration<double>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*******************************************************************************
+ * MyResources.
+ ******************************************************************************/
+MyResources* MyResources::_instance = nullptr;
+
+MyResources* MyResources::GetInstance()
+{
+    return _instance == nullptr ? _instance = new MyResources() : _instance;
+}
+
+MyResources::MyResources():
+_loadTime(0.0)
+{
+
+}
+
+axImage* MyResources::GetImage(const std::string& path)
+{
+    std::map<std::string, axImage*>::iterator it = _images.find(path);
+    
+    if(it != _images.end())
+    {
+        return it->second;
+    }
+    
+    const double start = Now();
+    axImage* img = new axImage(path);
+    _loadTime += Now() - start;
+    
+    _images[path] = img;
+    return img;
+}
+
+axAudioBuffer* MyResources::GetSound(const std::string& path)
+{
+    std::map<std::string, axAudioBuffer*>::iterator it = _sounds.find(path);
+    
+    if(it != _sounds.end())
+    {
+        return it->second;
+    }
+    
+    const double start = Now();
+    axAudioBuffer* buffer = new axAudioBuffer(path);
+    _loadTime += Now() - start;
+    
+    _sounds[path] = buffer;
+    return buffer;
+}
+
+std::string MyResources::GetAppPath(const std::string& name)
+{
+    // Looked up once, on first use.
+    if(_appDirectory.empty())
+    {
+        _appDirectory = axApp::GetInstance()->GetAppDirectory();
+    }
+    
+    return _appDirectory + name;
+}
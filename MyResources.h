@@ -0,0 +1,47 @@
+#ifndef __MY_RESOURCES__
+#define __MY_RESOURCES__
+
+#include <map>
+#include <string>
+
+#include "axLib.h"
+#include "axAudioBuffer.h"
+
+/// Images and sounds shared by every widget. Each file is decoded the first
+/// time it's asked for and kept until exit, so twenty LEDs share one image
+/// and nothing is loaded before it's drawn or played. GUI thread only.
+class MyResources
+{
+public:
+    static MyResources* GetInstance();
+    
+    /// path as axImage takes it.
+    axImage* GetImage(const std::string& path);
+    
+    axAudioBuffer* GetSound(const std::string& path);
+    
+    /// path in the application directory.
+    std::string GetAppPath(const std::string& name);
+    
+    /// Seconds spent decoding so far.
+    double GetLoadTime() const
+    {
+        return _loadTime;
+    }
+    
+    int GetLoadCount() const
+    {
+        return (int)(_images.size() + _sounds.size());
+    }
+    
+private:
+    MyResources();
+    static MyResources* _instance;
+    
+    std::map<std::string, axImage*> _images;
+    std::map<std::string, axAudioBuffer*> _sounds;
+    std::string _appDirectory;
+    double _loadTime;
+};
+
+#endif // __MY_RESOURCES__
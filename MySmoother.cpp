@@ -0,0 +1,103 @@
+#include "MySmoother.h"
+#include "MyVectorOps.h"
+#include <algorithm>
+#include <cmath>
+
+/*******************************************************************************
+ * MySmoother.
+ ******************************************************************************/
+MySmoother::MySmoother(const Mode& mode, const double& time):
+_mode(mode),
+_sampleRate(44100.0),
+_time(time),
+_value(0.0f),
+_target(0.0f),
+_step(0.0f),
+_rampLeft(0)
+{
+    UpdateCoef();
+}
+
+void MySmoother::SetSampleRate(const double& sampleRate)
+{
+    if(sampleRate == _sampleRate)
+    {
+        return;
+    }
+    
+    _sampleRate = sampleRate;
+    UpdateCoef();
+    
+    // Restart the ramp at the new rate from where it is.
+    if(_mode == LINEAR && !IsSettled())
+    {
+        SetTarget(_target);
+    }
+}
+
+void MySmoother::SetTime(const double& time)
+{
+    _time = std::max(0.0, time);
+    UpdateCoef();
+}
+
+void MySmoother::SetTarget(const float& target)
+{
+    _target = target;
+    
+    if(_mode == LINEAR)
+    {
+        const double frames = floor(_time * _sampleRate);
+        _rampLeft = (unsigned long)frames;
+        _step = _rampLeft ? (float)((target - _value) / frames) : 0.0f;
+        
+        if(_rampLeft == 0)
+        {
+            _value = target;
+        }
+    }
+    else if(_coef == 0.0f)
+    {
+        _value = target;
+    }
+}
+
+void MySmoother::SetValue(const float& value)
+{
+    _value = _target = value;
+    _rampLeft = 0;
+}
+
+bool MySmoother::Process(float* buffer, const unsigned long& frameCount)
+{
+    if(IsSettled() || frameCount == 0)
+    {
+        return false;
+    }
+    
+    if(_mode == LINEAR)
+    {
+        const unsigned long n = std::min(frameCount, _rampLeft);
+        MyLinearRamp(buffer, n, _value, _step);
+        std::fill(buffer + n, buffer + frameCount, _target);
+        
+        _rampLeft -= n;
+        _value = _rampLeft ? buffer[n - 1] : _target;
+        return true;
+    }
+    
+    MyExpRamp(buffer, frameCount, _target, _value - _target, _coef);
+    _value = buffer[frameCount - 1];
+    
+    if(fabsf(_value - _target) < SETTLE)
+    {
+        _value = _target;
+    }
+    
+    return true;
+}
+
+void MySmoother::UpdateCoef()
+{
+    _coef = _time > 0.0 ? (float)exp(-1.0 / (_time * _sampleRate)) : 0.0f;
+}
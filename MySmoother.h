@@ -0,0 +1,64 @@
+#ifndef __MY_SMOOTHER__
+#define __MY_SMOOTHER__
+
+/// Glides a parameter to its target instead of jumping, so knob moves and
+/// automation don't zipper. Rendered a block at a time into a buffer the
+/// caller reads per sample. Once settled Process returns false without
+/// touching the buffer, the caller then uses GetValue as a constant and the
+/// steady state costs nothing.
+class MySmoother
+{
+public:
+    enum Mode
+    {
+        ONE_POLE, // Exponential, time is the time constant.
+        LINEAR    // Straight line, time is the ramp length.
+    };
+    
+    MySmoother(const Mode& mode = ONE_POLE, const double& time = 0.01);
+    
+    void SetSampleRate(const double& sampleRate);
+    
+    /// In seconds, 0 jumps.
+    void SetTime(const double& time);
+    
+    void SetTarget(const float& target);
+    
+    /// Jumps, no glide.
+    void SetValue(const float& value);
+    
+    float GetValue() const
+    {
+        return _value;
+    }
+    
+    float GetTarget() const
+    {
+        return _target;
+    }
+    
+    bool IsSettled() const
+    {
+        return _value == _target;
+    }
+    
+    /// Next frameCount values, or false once settled.
+    bool Process(float* buffer, const unsigned long& frameCount);
+    
+    /// Distance from the target under which a one pole snaps to it.
+    static constexpr float SETTLE = 1e-4f;
+    
+private:
+    void UpdateCoef();
+    
+    Mode _mode;
+    double _sampleRate;
+    double _time;
+    float _value;
+    float _target;
+    float _coef; // One pole, per frame.
+    float _step; // Linear, per frame.
+    unsigned long _rampLeft; // Linear, frames.
+};
+
+#endif // __MY_SMOOTHER__
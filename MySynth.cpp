@@ -0,0 +1,697 @@
+#include "MySynth.h"
+#include "MyRealtimeCheck.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+/*******************************************************************************
+ * MySynth.
+ ******************************************************************************/
+MySynth::MySynth(const double& sampleRate):
+_commands(new MyLockFreeQueue<Command, 1024>()),
+_presetSlot(new MyPreset()),
+_presetPending(false),
+_midi(new MyLockFreeQueue<MyMidiMessage, 1024>()),
+_hasPendingMidi(false),
+_midiSync(false),
+_transport(STOPPED),
+_songTicks(0),
+_frame(0),
+_playingStep(-1),
+_recordAutomation(false),
+_running(false)
+{
+    _engine = new MySynthEngine(sampleRate, 1, 0);
+    _engine->SetProfiling(true);
+    _profiler.SetSampleRate(sampleRate);
+    _clock.SetSampleRate(sampleRate);
+    
+    // Starts out the same as the line's own bank.
+    _guiBank = new MyPatternBank();
+    _editPattern = 0;
+    _guiNotes = _guiBank->GetPattern(_editPattern)->notes;
+}
+
+MySynth::~MySynth()
+{
+    // The reader thread posts into the queue until then.
+    _midiInput.Close();
+    
+    delete _engine;
+    delete _guiBank;
+    delete _commands;
+    delete _presetSlot;
+    delete _midi;
+}
+
+void MySynth::SetRunning(const bool& running)
+{
+    if(running && !_running)
+    {
+        // Knobs set before the stream starts don't glide in from their
+        // defaults.
+        for(int i = 0; i < _engine->GetNumLines(); i++)
+        {
+            _engine->GetLine(i)->SettleParameters();
+        }
+        
+        // The gap since the last run isn't an xrun.
+        _profiler.Reset();
+    }
+    
+    _running = running;
+    
+    // Nothing else consumes the queue anymore.
+    if(!running)
+    {
+        ProcessCommands();
+    }
+}
+
+bool MySynth::PostCommand(const Command& cmd)
+{
+    // When the stream isn't running there is no audio thread to race with.
+    if(!_running)
+    {
+        ApplyCommand(cmd);
+        return true;
+    }
+    
+    if(!_commands->Push(cmd))
+    {
+        std::cerr << "MySynth : command queue full, "
+                     "dropped command " << cmd.type << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+void MySynth::PostValue(const Command::Type& type, const double& value)
+{
+    Command cmd(type);
+    cmd.value = value;
+    PostCommand(cmd);
+}
+
+void MySynth::PostIndex(const Command::Type& type, const int& index)
+{
+    Command cmd(type);
+    cmd.index = index;
+    PostCommand(cmd);
+}
+
+void MySynth::PostNote(const int& index)
+{
+    Command cmd(Command::NOTE);
+    cmd.pattern = _editPattern;
+    cmd.index = index;
+    cmd.note = _guiNotes[index];
+    PostCommand(cmd);
+}
+
+void MySynth::ProcessCommands()
+{
+    Command cmd;
+    
+    while(_commands->Pop(cmd))
+    {
+        ApplyCommand(cmd);
+    }
+}
+
+void MySynth::ApplyCommand(const Command& cmd)
+{
+    MySynthVoice* voice = _engine->GetLine(0);
+    
+    switch(cmd.type)
+    {
+        case Command::NOTE:
+            voice->SetNote(cmd.pattern, cmd.index, cmd.note);
+            break;
+        
+        case Command::WAVEFORM:
+            voice->SetWaveformType(
+                static_cast<MyOscillator::Waveform>(cmd.index));
+            break;
+        
+        case Command::PULSE_WIDTH:
+            voice->SetPulseWidth(cmd.value);
+            break;
+        
+        case Command::FILTER_FREQ:
+            voice->SetFilterFreq(cmd.value);
+            break;
+        
+        case Command::FILTER_RES:
+            voice->SetFilterRes(cmd.value);
+            break;
+        
+        case Command::ENV_MOD:
+            voice->SetEnvMod(cmd.value);
+            break;
+        
+        case Command::ACCENT:
+            voice->SetAccent(cmd.value);
+            break;
+        
+        case Command::VOLUME:
+            voice->SetVolume(cmd.value);
+            break;
+        
+        case Command::DECAY:
+            voice->SetDecay(cmd.value);
+            break;
+        
+        case Command::TUNING:
+            voice->SetTuning(cmd.value);
+            break;
+        
+        case Command::BPM:
+            voice->SetBpm(cmd.value);
+            break;
+        
+        case Command::SAMPLE_RATE:
+            _engine->SetSampleRate(cmd.value);
+            _profiler.SetSampleRate(cmd.value);
+            _clock.SetSampleRate(cmd.value);
+            break;
+        
+        case Command::OVERSAMPLING:
+            voice->SetOversampling(cmd.index);
+            break;
+        
+        case Command::SELECT_PATTERN:
+            voice->SelectPattern(cmd.pattern);
+            break;
+        
+        case Command::PATTERN_LENGTH:
+            voice->SetPatternLength(cmd.pattern, cmd.index);
+            break;
+        
+        case Command::CHAIN_ENTRY:
+            voice->SetChainEntry(cmd.index, cmd.pattern);
+            break;
+        
+        case Command::CHAIN_LENGTH:
+            voice->SetChainLength(cmd.index);
+            break;
+        
+        case Command::SONG_MODE:
+            voice->SetSongMode(cmd.index != 0);
+            break;
+        
+        case Command::MIDI_SYNC:
+            _midiSync = cmd.index != 0;
+            _transport = STOPPED;
+            
+            // Waits for Start when synced, runs on its own otherwise.
+            voice->SetPlaying(!_midiSync);
+            break;
+        
+        case Command::AUTOMATION:
+            voice->SetAutomation(cmd.pattern, cmd.index, cmd.lane, cmd.value);
+            break;
+        
+        case Command::CLEAR_AUTOMATION:
+            voice->ClearAutomation(cmd.pattern);
+            break;
+        
+        case Command::LOAD_PRESET:
+            voice->SetPreset(*_presetSlot, cmd.pattern);
+            _presetPending.store(false, std::memory_order_release);
+            break;
+    }
+}
+
+void MySynth::SetSampleRate(const double& sampleRate)
+{
+    PostValue(Command::SAMPLE_RATE, sampleRate);
+}
+
+void MySynth::SetOversampling(const int& factor)
+{
+    PostIndex(Command::OVERSAMPLING, factor);
+}
+
+void MySynth::SetVolume(const double& volume)
+{
+    _guiPreset.volume = volume;
+    PostValue(Command::VOLUME, volume);
+}
+
+void MySynth::SetWaveformType(const MyOscillator::Waveform& type)
+{
+    _guiPreset.waveform = type;
+    PostIndex(Command::WAVEFORM, static_cast<int>(type));
+}
+
+void MySynth::SetPulseWidth(const double& width)
+{
+    _guiPreset.pulseWidth = width;
+    PostValue(Command::PULSE_WIDTH, width);
+}
+
+void MySynth::SetFilterFreq(const double& freq)
+{
+    _guiPreset.cutoff = freq;
+    PostValue(Command::FILTER_FREQ, freq);
+    RecordAutomation(MyPatternBank::CUTOFF, freq);
+}
+
+void MySynth::SetFilterRes(const double& res)
+{
+    _guiPreset.res = res;
+    PostValue(Command::FILTER_RES, res);
+    RecordAutomation(MyPatternBank::RES, res);
+}
+
+void MySynth::SetEnvMod(const double& envMod)
+{
+    _guiPreset.envMod = envMod;
+    PostValue(Command::ENV_MOD, envMod);
+    RecordAutomation(MyPatternBank::ENV_MOD, envMod);
+}
+
+void MySynth::SetAccent(const double& accent)
+{
+    _guiPreset.accent = accent;
+    PostValue(Command::ACCENT, accent);
+    RecordAutomation(MyPatternBank::ACCENT, accent);
+}
+
+void MySynth::SetDecay(const double& decay)
+{
+    _guiPreset.decay = decay;
+    PostValue(Command::DECAY, decay);
+    RecordAutomation(MyPatternBank::DECAY, decay);
+}
+
+void MySynth::SetTuning(const double& tune)
+{
+    _guiPreset.tuning = tune;
+    PostValue(Command::TUNING, tune);
+}
+
+void MySynth::SetBpm(const double& bpm)
+{
+    _guiPreset.bpm = std::max(20.0, std::min(bpm, 300.0));
+    PostValue(Command::BPM, _guiPreset.bpm);
+}
+
+void MySynth::SetAutomation(const int& index,
+                            const int& lane,
+                            const double& value)
+{
+    _guiBank->SetAutomation(_editPattern, index, lane, value);
+    
+    Command cmd(Command::AUTOMATION);
+    cmd.pattern = _editPattern;
+    cmd.index = index;
+    cmd.lane = lane;
+    cmd.value = value;
+    PostCommand(cmd);
+}
+
+void MySynth::ClearAutomation()
+{
+    _guiBank->ClearAutomation(_editPattern);
+    Command cmd(Command::CLEAR_AUTOMATION);
+    cmd.pattern = _editPattern;
+    PostCommand(cmd);
+}
+
+void MySynth::SetAutomationRecord(const bool& record)
+{
+    _recordAutomation = record;
+}
+
+void MySynth::RecordAutomation(const int& lane, const double& value)
+{
+    if(!_recordAutomation || !_running)
+    {
+        return;
+    }
+    
+    // The step that was playing at the end of the last block. The knob
+    // reaches the audio thread on the next one, so only a move right on
+    // a step boundary lands one step early.
+    const int playing = _playingStep.load(std::memory_order_relaxed);
+    
+    if(playing < 0)
+    {
+        return;
+    }
+    
+    const int pattern = playing / MyPatternBank::MAX_STEPS;
+    const int step = playing % MyPatternBank::MAX_STEPS;
+    _guiBank->SetAutomation(pattern, step, lane, value);
+    
+    Command cmd(Command::AUTOMATION);
+    cmd.pattern = pattern;
+    cmd.index = step;
+    cmd.lane = lane;
+    cmd.value = value;
+    PostCommand(cmd);
+}
+
+void MySynth::SetNoteInfo(const int& index, const Note& note)
+{
+    _guiNotes[index] = note;
+    PostNote(index);
+}
+
+void MySynth::SetNoteInfoNote(const int& index, const int& note)
+{
+    _guiNotes[index].note = note;
+    PostNote(index);
+}
+
+void MySynth::SetNoteInfoOn(const int& index, const bool& on)
+{
+    _guiNotes[index].on = on;
+    PostNote(index);
+}
+
+void MySynth::SetNoteInfoUp(const int& index, const bool& up)
+{
+    _guiNotes[index].up = up;
+    PostNote(index);
+}
+
+void MySynth::SetNoteInfoDown(const int& index, const bool& down)
+{
+    _guiNotes[index].down = down;
+    PostNote(index);
+}
+
+void MySynth::SetNoteInfoAccent(const int& index, const bool& accent)
+{
+    _guiNotes[index].accent = accent;
+    PostNote(index);
+}
+
+void MySynth::SetNoteInfoSlide(const int& index, const bool& slide)
+{
+    _guiNotes[index].slide = slide;
+    PostNote(index);
+}
+
+void MySynth::SelectPattern(const int& pattern)
+{
+    _editPattern = std::max(0, std::min(pattern,
+                                    MyPatternBank::NUM_PATTERNS - 1));
+    _guiNotes = _guiBank->GetPattern(_editPattern)->notes;
+    Command cmd(Command::SELECT_PATTERN);
+    cmd.pattern = _editPattern;
+    PostCommand(cmd);
+}
+
+void MySynth::SetPatternLength(const int& length)
+{
+    _guiBank->SetLength(_editPattern, length);
+    Command cmd(Command::PATTERN_LENGTH);
+    cmd.pattern = _editPattern;
+    cmd.index = GetPatternLength();
+    PostCommand(cmd);
+}
+
+void MySynth::SetChain(const std::vector<int>& patterns)
+{
+    const int length = std::max(1, std::min((int)patterns.size(),
+                                            MyPatternBank::MAX_CHAIN));
+    
+    for(int i = 0; i < length && i < (int)patterns.size(); i++)
+    {
+        _guiBank->SetChainEntry(i, patterns[i]);
+        Command cmd(Command::CHAIN_ENTRY);
+        cmd.index = i;
+        cmd.pattern = _guiBank->GetChainEntry(i);
+        PostCommand(cmd);
+    }
+    
+    _guiBank->SetChainLength(length);
+    PostIndex(Command::CHAIN_LENGTH, length);
+}
+
+void MySynth::SetSongMode(const bool& song)
+{
+    PostIndex(Command::SONG_MODE, song ? 1 : 0);
+}
+
+bool MySynth::OpenPresetLibrary(const std::string& path)
+{
+    return _presetLibrary.Open(path);
+}
+
+bool MySynth::LoadPreset(const int& index)
+{
+    // The audio thread may still be reading the slot.
+    if(_presetPending.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    
+    if(!_presetLibrary.Read(index, *_presetSlot))
+    {
+        return false;
+    }
+    
+    // One command for the whole preset, knobs set one by one would take
+    // hundreds of queue entries.
+    _presetPending.store(true, std::memory_order_relaxed);
+    
+    Command cmd(Command::LOAD_PRESET);
+    cmd.pattern = _editPattern;
+    
+    if(!PostCommand(cmd))
+    {
+        _presetPending.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    
+    // Loading isn't a knob move, nothing is recorded.
+    _guiPreset = *_presetSlot;
+    _guiPreset.bpm = std::max(20.0, std::min(_guiPreset.bpm, 300.0));
+    *_guiBank->GetPattern(_editPattern) = _presetSlot->pattern;
+    _guiBank->SetLength(_editPattern, _presetSlot->pattern.length);
+    return true;
+}
+
+bool MySynth::SavePreset(const std::string& path)
+{
+    _guiPreset.pattern = *_guiBank->GetPattern(_editPattern);
+    return MyPresetFile::Save(path, &_guiPreset, 1);
+}
+
+bool MySynth::OpenMidiInput(const std::string& path)
+{
+    return _midiInput.Open(path, this);
+}
+
+void MySynth::CloseMidiInput()
+{
+    _midiInput.Close();
+}
+
+void MySynth::SetMidiSync(const bool& sync)
+{
+    PostIndex(Command::MIDI_SYNC, sync ? 1 : 0);
+}
+
+void MySynth::PostMidi(const MyMidiMessage& msg)
+{
+    // Dropped when full, nothing sensible to do from the MIDI thread.
+    _midi->Push(msg);
+}
+
+void MySynth::OnMidi(const MyMidiMessage& msg)
+{
+    PostMidi(msg);
+}
+
+void MySynth::ApplyMidi(const MyMidiMessage& msg)
+{
+    MySynthVoice* voice = _engine->GetLine(0);
+    
+    // Omni, the channel is ignored.
+    const unsigned char status = msg.status < 0xF0 ? msg.status & 0xF0 :
+                                                     msg.status;
+    
+    // Folded into the range of the pitch table by octaves.
+    int note = msg.data1 - BASE_MIDI_NOTE;
+    
+    while(note < MyPitchTable::MIN_NOTE)
+    {
+        note += 12;
+    }
+    
+    while(note > MyPitchTable::MAX_NOTE)
+    {
+        note -= 12;
+    }
+    
+    switch(status)
+    {
+        case MyMidiMessage::NOTE_ON:
+            if(msg.data2 > 0)
+            {
+                voice->NoteOn(note, msg.data2 >= ACCENT_VELOCITY);
+                break;
+            }
+            
+            // Velocity 0 is a note off.
+            voice->NoteOff(note);
+            break;
+        
+        case MyMidiMessage::NOTE_OFF:
+            voice->NoteOff(note);
+            break;
+        
+        case MyMidiMessage::START:
+            if(_midiSync)
+            {
+                _clock.Reset();
+                _transport = WAIT_START;
+            }
+            break;
+        
+        case MyMidiMessage::CONTINUE:
+            if(_midiSync && _transport == STOPPED)
+            {
+                _transport = WAIT_CONTINUE;
+            }
+            break;
+        
+        case MyMidiMessage::STOP:
+            if(_midiSync)
+            {
+                voice->SetPlaying(false);
+                _transport = STOPPED;
+            }
+            break;
+        
+        case MyMidiMessage::CLOCK:
+            if(_midiSync)
+            {
+                ApplyClock();
+            }
+            break;
+    }
+}
+
+void MySynth::ApplyClock()
+{
+    MySynthVoice* voice = _engine->GetLine(0);
+    
+    _clock.Tick((double)_frame);
+    
+    // The smoothed tempo sets the step length, SyncStep takes care of the
+    // phase.
+    if(_clock.HasTempo())
+    {
+        const double stepLength = _clock.GetPeriod() * TICKS_PER_STEP;
+        
+        if(fabs(stepLength - voice->GetStepLength()) > 0.5)
+        {
+            voice->SetBpm(_clock.GetBpm());
+        }
+    }
+    
+    switch(_transport)
+    {
+        case STOPPED:
+            return;
+        
+        case WAIT_START:
+            voice->Start();
+            _songTicks = 0;
+            _transport = RUNNING;
+            break;
+        
+        case WAIT_CONTINUE:
+            voice->SetPlaying(true);
+            _transport = RUNNING;
+            
+            if(_songTicks % TICKS_PER_STEP == 0)
+            {
+                voice->SyncStep();
+            }
+            break;
+        
+        case RUNNING:
+            if(_songTicks % TICKS_PER_STEP == 0)
+            {
+                voice->SyncStep();
+            }
+            break;
+    }
+    
+    ++_songTicks;
+}
+
+bool MySynth::PopStepEvent(StepEvent& event)
+{
+    return _engine->GetLine(0)->PopStepEvent(event);
+}
+
+void MySynth::Process(float* output,
+                      const unsigned long& frameCount,
+                      const int& numChannels)
+{
+    MyRealtimeCheck::Scope realtime;
+    
+    _profiler.BeginBlock();
+    
+    ProcessCommands();
+    
+    // Messages are placed one block later than they were received, at
+    // the same offset.
+    const double sampleRate = _engine->GetSampleRate();
+    const double origin = MyProfiler::Now() - frameCount / sampleRate;
+    unsigned long frame = 0;
+    
+    while(_hasPendingMidi || _midi->Pop(_pendingMidi))
+    {
+        _hasPendingMidi = true;
+        
+        const double offset = floor((_pendingMidi.time - origin) * sampleRate);
+        
+        if(offset >= frameCount)
+        {
+            break;
+        }
+        
+        // Late ones (GUI stall, first block) go right away.
+        const unsigned long at = (unsigned long)std::max(offset, (double)frame);
+        
+        if(at > frame)
+        {
+            _engine->Process(output + frame * numChannels, at - frame,
+                             numChannels);
+            _frame += at - frame;
+            frame = at;
+        }
+        
+        ApplyMidi(_pendingMidi);
+        _hasPendingMidi = false;
+    }
+    
+    if(frame < frameCount)
+    {
+        _engine->Process(output + frame * numChannels, frameCount - frame,
+                         numChannels);
+        _frame += frameCount - frame;
+    }
+    
+    // Where knob moves get recorded.
+    const MySynthVoice* voice = _engine->GetLine(0);
+    const int step = voice->GetStep();
+    _playingStep.store(voice->IsPlaying() && step >= 0 ?
+                       voice->GetPatternIndex() * MyPatternBank::MAX_STEPS +
+                       step : -1, std::memory_order_relaxed);
+    
+    double stages[MyProfiler::NUM_STAGES];
+    _engine->TakeStageTimes(stages);
+    _profiler.EndBlock(frameCount, stages);
+}
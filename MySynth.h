@@ -0,0 +1,275 @@
+#ifndef __MY_SYNTH__
+#define __MY_SYNTH__
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "MyLockFreeQueue.h"
+#include "MyMidiClock.h"
+#include "MyMidiInput.h"
+#include "MyProfiler.h"
+#include "MySynthEngine.h"
+
+/// The synth without any device or window: an engine, the GUI side copy of
+/// its pattern bank and knobs, and the command queue in between. It doesn't
+/// depend on axLib, so it can run headless and have any number of
+/// instances. MyAudioSynth plugs it into an axAudio stream.
+class MySynth : private MyMidiInput::Listener
+{
+public:
+    MySynth(const double& sampleRate = 44100.0);
+    ~MySynth();
+    
+    // Setters are called from the control thread. While running they only
+    // post a command that Process applies at the start of its next block.
+    void SetWaveformType(const MyOscillator::Waveform& type);
+    void SetPulseWidth(const double& width);
+    
+    void SetFilterFreq(const double& freq);
+    void SetFilterRes(const double& res);
+    void SetEnvMod(const double& envMod);
+    void SetAccent(const double& accent);
+    
+    void SetSampleRate(const double& sampleRate);
+    
+    /// Runs the oscillator and filter at 1, 2, 4 or 8 times the sample rate.
+    void SetOversampling(const int& factor);
+    
+    void SetVolume(const double& volume);
+    
+    /// Tempo in beats per minute, one step per sixteenth note.
+    void SetBpm(const double& bpm);
+    
+    double GetBpm() const
+    {
+        return _guiPreset.bpm;
+    }
+    
+    void SetDecay(const double& decay);
+    
+    typedef MySynthVoice::Note Note;
+    
+    /// Control side copy of the pattern being edited.
+    const Note* GetNotes() const
+    {
+        return _guiNotes;
+    }
+    
+    /// Edits pattern from now on and plays it from the next bar.
+    void SelectPattern(const int& pattern);
+    
+    int GetPattern() const
+    {
+        return _editPattern;
+    }
+    
+    /// Length of the pattern being edited, from 1 to 64 steps.
+    void SetPatternLength(const int& length);
+    
+    int GetPatternLength() const
+    {
+        return _guiBank->GetPattern(_editPattern)->length;
+    }
+    
+    /// Patterns played in order in song mode.
+    void SetChain(const std::vector<int>& patterns);
+    void SetSongMode(const bool& song);
+    
+    void SetNoteInfo(const int& index, const Note& note);
+    void SetNoteInfoNote(const int& index, const int& note);
+    void SetNoteInfoOn(const int& index, const bool& on);
+    void SetNoteInfoUp(const int& index, const bool& up);
+    void SetNoteInfoDown(const int& index, const bool& down);
+    void SetNoteInfoAccent(const int& index, const bool& accent);
+    void SetNoteInfoSlide(const int& index, const bool& slide);
+    
+    void SetTuning(const double& tune);
+    
+    /// Knob value of a MyPatternBank::Lane at a step of the pattern being
+    /// edited, set again each time the step plays.
+    void SetAutomation(const int& index, const int& lane, const double& value);
+    
+    /// Every lane of the pattern being edited.
+    void ClearAutomation();
+    
+    /// While recording, moving cutoff, resonance, env mod, decay or accent
+    /// during playback writes the value into the step playing.
+    void SetAutomationRecord(const bool& record);
+    
+    bool IsAutomationRecord() const
+    {
+        return _recordAutomation;
+    }
+    
+    typedef MySynthVoice::StepEvent StepEvent;
+    
+    /// Steps played since the last call, oldest first, for the control
+    /// thread.
+    bool PopStepEvent(StepEvent& event);
+    
+    /// Block timings. Poll it from the control thread.
+    MyProfiler& GetProfiler()
+    {
+        return _profiler;
+    }
+    
+    /// Maps a preset library, see MyPresetFile.
+    bool OpenPresetLibrary(const std::string& path);
+    
+    int GetNumPresets() const
+    {
+        return _presetLibrary.GetNumPresets();
+    }
+    
+    /// Knobs and steps of a preset of the open library into the pattern
+    /// being edited. Fails while the audio thread hasn't applied the last
+    /// one yet.
+    bool LoadPreset(const int& index);
+    
+    /// Knobs and the pattern being edited as a one preset file.
+    bool SavePreset(const std::string& path);
+    
+    /// Reads MIDI from a rawmidi device or a named pipe, see MyMidiInput.
+    /// Notes play the voice live on any channel, MIDI note BASE_MIDI_NOTE
+    /// being step note 0 and velocities from ACCENT_VELOCITY accented.
+    bool OpenMidiInput(const std::string& path);
+    void CloseMidiInput();
+    
+    /// The sequencer follows MIDI Start, Stop, Continue and Clock instead of
+    /// running on its own.
+    void SetMidiSync(const bool& sync);
+    
+    /// Queues a message from some other MIDI source, time in
+    /// MyProfiler::Now seconds. Only one thread may post, and not while a
+    /// MIDI input is open.
+    void PostMidi(const MyMidiMessage& msg);
+    
+    static const int BASE_MIDI_NOTE = 36;
+    static const int ACCENT_VELOCITY = 100;
+    
+    /// Set while another thread calls Process. When it stops, the pending
+    /// commands are applied right away.
+    void SetRunning(const bool& running);
+    
+    /// Renders frameCount interleaved frames of numChannels. Real time safe.
+    /// MIDI received during the previous block lands at the same offset in
+    /// this one, one block of latency buys sample accurate timing.
+    void Process(float* output,
+                 const unsigned long& frameCount,
+                 const int& numChannels = 2);
+                 
+private:
+    MySynth(const MySynth&);
+    MySynth& operator=(const MySynth&);
+    
+    struct Command
+    {
+        enum Type
+        {
+            NOTE,
+            WAVEFORM,
+            PULSE_WIDTH,
+            FILTER_FREQ,
+            FILTER_RES,
+            ENV_MOD,
+            ACCENT,
+            VOLUME,
+            DECAY,
+            TUNING,
+            BPM,
+            SAMPLE_RATE,
+            OVERSAMPLING,
+            SELECT_PATTERN,
+            PATTERN_LENGTH,
+            CHAIN_ENTRY,
+            CHAIN_LENGTH,
+            SONG_MODE,
+            MIDI_SYNC,
+            AUTOMATION,
+            CLEAR_AUTOMATION,
+            LOAD_PRESET
+        };
+        
+        Command(const Type& t = NOTE):
+        type(t),
+        index(0),
+        value(0.0),
+        note(),
+        pattern(0),
+        lane(0)
+        {
+        }
+        
+        Type type;
+        int index;
+        double value;
+        Note note;
+        int pattern;
+        int lane;
+    };
+    
+    bool PostCommand(const Command& cmd);
+    void PostValue(const Command::Type& type, const double& value);
+    void PostIndex(const Command::Type& type, const int& index);
+    void PostNote(const int& index);
+    void ApplyCommand(const Command& cmd);
+    void ProcessCommands();
+    void RecordAutomation(const int& lane, const double& value);
+    
+    virtual void OnMidi(const MyMidiMessage& msg);
+    void ApplyMidi(const MyMidiMessage& msg);
+    void ApplyClock();
+    
+    // Transport while synced to MIDI. Start and Continue take effect on
+    // the next clock tick, like on hardware.
+    enum Transport
+    {
+        STOPPED,
+        WAIT_START,
+        WAIT_CONTINUE,
+        RUNNING
+    };
+    
+    static const int TICKS_PER_STEP = MyMidiClock::TICKS_PER_QUARTER / 4;
+    
+    // Control thread -> audio thread.
+    MyLockFreeQueue<Command, 1024>* _commands;
+    
+    // A whole preset doesn't fit in the queue. LOAD_PRESET reads it from
+    // here, and the control thread doesn't write it again until the audio
+    // thread clears the pending flag.
+    MyPreset* _presetSlot;
+    std::atomic<bool> _presetPending;
+    
+    // Audio thread state. The GUI edits the engine's first line.
+    MySynthEngine* _engine;
+    MyProfiler _profiler;
+    
+    // MIDI thread -> audio thread, the pending message is the first one
+    // not due yet.
+    MyMidiInput _midiInput;
+    MyLockFreeQueue<MyMidiMessage, 1024>* _midi;
+    MyMidiMessage _pendingMidi;
+    bool _hasPendingMidi;
+    MyMidiClock _clock;
+    bool _midiSync;
+    Transport _transport;
+    long _songTicks; // Clock ticks since Start while running.
+    unsigned long long _frame; // Frames rendered.
+    
+    // Audio thread -> control thread, pattern * MAX_STEPS + step playing,
+    // -1 when stopped.
+    std::atomic<int> _playingStep;
+    
+    // Control thread state.
+    MyPatternBank* _guiBank;
+    int _editPattern;
+    Note* _guiNotes; // Steps of _editPattern in _guiBank.
+    MyPreset _guiPreset; // Knob values, the steps live in _guiBank.
+    MyPresetFile _presetLibrary;
+    bool _recordAutomation;
+    bool _running;
+};
+
+#endif // __MY_SYNTH__
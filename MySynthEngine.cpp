@@ -0,0 +1,146 @@
+#include "MySynthEngine.h"
+#include "MyRealtimeCheck.h"
+#include "MyVectorOps.h"
+#include <algorithm>
+
+/*******************************************************************************
+ * MySynthEngine.
+ ******************************************************************************/
+MySynthEngine::MySynthEngine(const double& sampleRate,
+                             const int& numLines,
+                             const int& numThreads):
+_sampleRate(sampleRate),
+_blockFrames(0),
+_profiling(false)
+{
+    int threads = numThreads;
+    
+    if(threads < 0)
+    {
+        threads = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+    }
+    
+    _pool = new MyWorkerPool(threads);
+    
+    for(int i = 0; i < numLines; i++)
+    {
+        AddLine();
+    }
+}
+
+MySynthEngine::~MySynthEngine()
+{
+    delete _pool;
+    
+    for(int i = 0; i < (int)_lines.size(); i++)
+    {
+        delete _lines[i];
+        delete[] _lineBuffers[i];
+    }
+}
+
+int MySynthEngine::AddLine()
+{
+    _lines.push_back(new MySynthVoice(_sampleRate));
+    _lines.back()->SetProfiling(_profiling);
+    _lineBuffers.push_back(new float[BLOCK_FRAMES]);
+    return (int)_lines.size() - 1;
+}
+
+void MySynthEngine::SetSampleRate(const double& sampleRate)
+{
+    _sampleRate = sampleRate;
+    
+    for(auto& line : _lines)
+    {
+        line->SetSampleRate(sampleRate);
+    }
+}
+
+void MySynthEngine::Reset()
+{
+    for(auto& line : _lines)
+    {
+        line->Reset();
+    }
+}
+
+void MySynthEngine::SetProfiling(const bool& profiling)
+{
+    _profiling = profiling;
+    
+    for(auto& line : _lines)
+    {
+        line->SetProfiling(profiling);
+    }
+}
+
+void MySynthEngine::TakeStageTimes(double* times)
+{
+    std::fill(times, times + MyProfiler::NUM_STAGES, 0.0);
+    
+    for(auto& line : _lines)
+    {
+        const double* lineTimes = line->GetStageTimes();
+        
+        for(int i = 0; i < MyProfiler::NUM_STAGES; i++)
+        {
+            times[i] += lineTimes[i];
+        }
+        
+        line->ResetStageTimes();
+    }
+}
+
+void MySynthEngine::Run(const int& index)
+{
+    MyRealtimeCheck::Scope realtime;
+    
+    _lines[index]->Process(_lineBuffers[index], _blockFrames);
+}
+
+void MySynthEngine::Process(float* output,
+                            const unsigned long& frameCount,
+                            const int& numChannels)
+{
+    MyRealtimeCheck::Scope realtime;
+    
+    const int numLines = (int)_lines.size();
+    
+    if(numLines == 0)
+    {
+        std::fill(output, output + frameCount * numChannels, 0.0f);
+        return;
+    }
+    
+    unsigned long frame = 0;
+    
+    while(frame < frameCount)
+    {
+        _blockFrames = std::min<unsigned long>(frameCount - frame,
+                                               BLOCK_FRAMES);
+        
+        // A single line needs no mix and no workers.
+        if(numLines == 1)
+        {
+            _lines[0]->Process(_mixBuffer, _blockFrames);
+        }
+        else
+        {
+            _pool->Dispatch(this, numLines);
+            
+            std::copy(_lineBuffers[0], _lineBuffers[0] + _blockFrames,
+                      _mixBuffer);
+            
+            for(int l = 1; l < numLines; l++)
+            {
+                MyAccumulate(_mixBuffer, _lineBuffers[l], _blockFrames);
+            }
+        }
+        
+        MyFanOut(_mixBuffer, output + frame * numChannels, _blockFrames,
+                 numChannels);
+        
+        frame += _blockFrames;
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef __MY_SYNTH_ENGINE__
+#define __MY_SYNTH_ENGINE__
+
+#include <vector>
+
+#include "MySynthVoice.h"
+#include "MyWorkerPool.h"
+
+/// Runs any number of independent 303 lines, each with its own pattern and
+/// parameters. Lines render mono in parallel on a worker pool, are summed,
+/// and the mix is only fanned out to the output channels at the end.
+class MySynthEngine : private MyWorkerPool::Job
+{
+public:
+    /// numThreads < 0 uses one worker per extra hardware core.
+    MySynthEngine(const double& sampleRate = 44100.0,
+                  const int& numLines = 1,
+                  const int& numThreads = -1);
+    ~MySynthEngine();
+    
+    /// Not real time safe, call while nothing is rendering.
+    int AddLine();
+    
+    int GetNumLines() const
+    {
+        return (int)_lines.size();
+    }
+    
+    /// Lines are configured from the thread that calls Process.
+    MySynthVoice* GetLine(const int& index)
+    {
+        return _lines[index];
+    }
+    
+    void SetSampleRate(const double& sampleRate);
+    
+    double GetSampleRate() const
+    {
+        return _sampleRate;
+    }
+    
+    /// Rewinds every line.
+    void Reset();
+    
+    /// Per stage timing of every line, see MyProfiler.
+    void SetProfiling(const bool& profiling);
+    
+    /// Seconds per MyProfiler::Stage summed over every line since the last
+    /// call, from the thread that calls Process.
+    void TakeStageTimes(double* times);
+    
+    /// Renders and mixes frameCount interleaved frames of numChannels.
+    void Process(float* output,
+                 const unsigned long& frameCount,
+                 const int& numChannels = 2);
+    
+    // Frames handed to the workers at once.
+    static const int BLOCK_FRAMES = 512;
+    
+private:
+    virtual void Run(const int& index);
+    
+    double _sampleRate;
+    MyWorkerPool* _pool;
+    std::vector<MySynthVoice*> _lines;
+    std::vector<float*> _lineBuffers;
+    float _mixBuffer[BLOCK_FRAMES];
+    unsigned long _blockFrames;
+    bool _profiling;
+};
+
+#endif // __MY_SYNTH_ENGINE__
@@ -0,0 +1,643 @@
+#include "MySynthVoice.h"
+#include "MyVectorOps.h"
+#include <algorithm>
+#include <cmath>
+
+/*******************************************************************************
+ * MySynthVoice.
+ ******************************************************************************/
+MySynthVoice::MySynthVoice(const double& sampleRate):
+_sampleRate(sampleRate),
+_oversampling(1),
+_cutoffOffset(MySmoother::ONE_POLE, 0.01),
+_res(MySmoother::ONE_POLE, 0.01),
+_tuningRatio(MySmoother::ONE_POLE, 0.01),
+_volume(MySmoother::LINEAR, 0.02)
+{
+    _osc.SetWaveform(MyOscillator::SQUARE);
+    
+    _osBuffer = new float[CHUNK_FRAMES * 8];
+    _modBuffer = new float[CHUNK_FRAMES * 8];
+    _cutoffBuffer = new float[CHUNK_FRAMES * 8];
+    _stepEvents = new MyLockFreeQueue<StepEvent, 256>();
+    _resBuffer = new float[CHUNK_FRAMES * 8];
+    
+    _frame = 0;
+    _playing = true;
+    _keyHeld = false;
+    _liveNote = 0;
+    _bpm = 120.0;
+    _mesureCount = 0;
+    _mesureTime = _sampleRate * 60.0 / (_bpm * 4.0);
+    _timeCount = 0.0;
+    
+    _decay = 0.5;
+    _decayIndex = 0.0;
+    
+    _pitch = _pitchTarget = 0.0f;
+    _filterFreq = 20000.0;
+    _envMod = 0.5;
+    _tuningRatio.SetValue(1.0f);
+    
+    _accent = 0.5;
+    _accentLevel = 0.0;
+    _accentCap = 0.0f;
+    _envHold = false;
+    _slideFromPrevious = false;
+    
+    _profiling = false;
+    ResetStageTimes();
+    
+    _pattern = _cuedPattern = _bank.GetPattern(0);
+    _songMode = false;
+    _chainPos = 0;
+    
+    _osc.SetSampleRate(_sampleRate);
+    _filter.SetSampleRate(_sampleRate);
+    UpdateTimeConstants();
+}
+
+MySynthVoice::~MySynthVoice()
+{
+    delete[] _osBuffer;
+    delete[] _modBuffer;
+    delete[] _cutoffBuffer;
+    delete[] _resBuffer;
+    delete _stepEvents;
+}
+
+void MySynthVoice::SetSampleRate(const double& sampleRate)
+{
+    _sampleRate = sampleRate;
+    _decimator.Reset();
+    _filter.Reset();
+    _osc.SetSampleRate(_sampleRate * _oversampling);
+    _filter.SetSampleRate(_sampleRate * _oversampling);
+    UpdateTimeConstants();
+}
+
+void MySynthVoice::SetOversampling(const int& factor)
+{
+    _decimator.SetFactor(factor);
+    _oversampling = _decimator.GetFactor();
+    _osc.SetSampleRate(_sampleRate * _oversampling);
+    _filter.SetSampleRate(_sampleRate * _oversampling);
+    UpdateTimeConstants();
+}
+
+void MySynthVoice::SetBpm(const double& bpm)
+{
+    _bpm = std::max(20.0, std::min(bpm, 300.0));
+    UpdateTimeConstants();
+}
+
+void MySynthVoice::SetWaveformType(const MyOscillator::Waveform& type)
+{
+    _osc.SetWaveform(type);
+}
+
+void MySynthVoice::SetPulseWidth(const double& width)
+{
+    _osc.SetPulseWidth(width);
+}
+
+void MySynthVoice::SetFilterFreq(const double& freq)
+{
+    const double previous = std::max(_filterFreq, 1.0);
+    _filterFreq = freq;
+    UpdateFilterFreq();
+    
+    _cutoffOffset.SetValue(_cutoffOffset.GetValue() +
+                           (float)log2(previous / std::max(freq, 1.0)));
+    _cutoffOffset.SetTarget(0.0f);
+}
+
+void MySynthVoice::SetFilterRes(const double& res)
+{
+    _filter.SetRes(res);
+    _res.SetTarget((float)std::max(0.0, std::min(res, 1.0)));
+}
+
+void MySynthVoice::SetEnvMod(const double& envMod)
+{
+    _envMod = std::max(0.0, std::min(envMod, 1.0));
+}
+
+void MySynthVoice::SetAccent(const double& accent)
+{
+    _accent = std::max(0.0, std::min(accent, 1.0));
+}
+
+void MySynthVoice::SetVolume(const double& volume)
+{
+    _volume.SetTarget((float)std::max(0.0, std::min(volume, 1.0)));
+}
+
+void MySynthVoice::SetDecay(const double& decay)
+{
+    _decay = std::max(0.0, std::min(decay, 1.0));
+    
+    // Automation calls this on the audio thread, the rest doesn't move.
+    UpdateDecayTime();
+}
+
+void MySynthVoice::SetTuning(const double& tune)
+{
+    const double previous = _pitchTable.GetTuning();
+    _pitchTable.SetTuning(tune);
+    
+    _tuningRatio.SetValue((float)(_tuningRatio.GetValue() * previous /
+                                  _pitchTable.GetTuning()));
+    _tuningRatio.SetTarget(1.0f);
+}
+
+void MySynthVoice::SetScale(const double* cents)
+{
+    _pitchTable.SetScale(cents);
+}
+
+void MySynthVoice::SetNote(const int& pattern,
+                           const int& index,
+                           const Note& note)
+{
+    _bank.GetPattern(pattern)->notes[index] = note;
+}
+
+void MySynthVoice::SetPatternLength(const int& pattern, const int& length)
+{
+    _bank.SetLength(pattern, length);
+}
+
+void MySynthVoice::SetAutomation(const int& pattern,
+                                 const int& step,
+                                 const int& lane,
+                                 const double& value)
+{
+    _bank.SetAutomation(pattern, step, lane, value);
+}
+
+void MySynthVoice::ClearAutomation(const int& pattern)
+{
+    _bank.ClearAutomation(pattern);
+}
+
+void MySynthVoice::SelectPattern(const int& pattern)
+{
+    _cuedPattern = _bank.GetPattern(pattern);
+}
+
+void MySynthVoice::SetChainEntry(const int& index, const int& pattern)
+{
+    _bank.SetChainEntry(index, pattern);
+}
+
+void MySynthVoice::SetChainLength(const int& length)
+{
+    _bank.SetChainLength(length);
+}
+
+void MySynthVoice::SetSongMode(const bool& song)
+{
+    _songMode = song;
+}
+
+void MySynthVoice::SetPreset(const MyPreset& preset, const int& pattern)
+{
+    SetTuning(preset.tuning);
+    SetFilterFreq(preset.cutoff);
+    SetFilterRes(preset.res);
+    SetEnvMod(preset.envMod);
+    SetDecay(preset.decay);
+    SetAccent(preset.accent);
+    SetVolume(preset.volume);
+    SetBpm(preset.bpm);
+    SetPulseWidth(preset.pulseWidth);
+    SetWaveformType(preset.waveform);
+    
+    *_bank.GetPattern(pattern) = preset.pattern;
+    SetPatternLength(pattern, preset.pattern.length);
+}
+
+void MySynthVoice::SetProfiling(const bool& profiling)
+{
+    _profiling = profiling;
+    ResetStageTimes();
+}
+
+void MySynthVoice::ResetStageTimes()
+{
+    std::fill(_stageTimes, _stageTimes + MyProfiler::NUM_STAGES, 0.0);
+}
+
+void MySynthVoice::SettleParameters()
+{
+    _cutoffOffset.SetValue(_cutoffOffset.GetTarget());
+    _res.SetValue(_res.GetTarget());
+    _tuningRatio.SetValue(_tuningRatio.GetTarget());
+    _volume.SetValue(_volume.GetTarget());
+}
+
+void MySynthVoice::Reset()
+{
+    _frame = 0;
+    _mesureCount = 0;
+    _chainPos = 0;
+    _pattern = _songMode ? _bank.GetPattern(_bank.GetChainEntry(0)) :
+                           _cuedPattern;
+    _timeCount = 0.0;
+    _decayIndex = _sampleRate;
+    _decimator.Reset();
+    _osc.Reset();
+    _filter.Reset();
+    _pitch = _pitchTarget;
+    _accentLevel = 0.0;
+    _accentCap = 0.0f;
+    _envHold = false;
+    _slideFromPrevious = false;
+    SettleParameters();
+}
+
+void MySynthVoice::Start()
+{
+    _mesureCount = 0;
+    _chainPos = 0;
+    _pattern = _songMode ? _bank.GetPattern(_bank.GetChainEntry(0)) :
+                           _cuedPattern;
+    _timeCount = 0.0;
+    _playing = true;
+}
+
+void MySynthVoice::SetPlaying(const bool& playing)
+{
+    _playing = playing;
+    
+    if(!playing)
+    {
+        _envHold = false;
+        _slideFromPrevious = false;
+    }
+}
+
+void MySynthVoice::SyncStep()
+{
+    // Phase of the grid at the tick, wrapped to half a step either way.
+    // Positive when the step already started.
+    double phase = _mesureTime - _timeCount;
+    
+    if(phase > _mesureTime * 0.5)
+    {
+        phase -= _mesureTime;
+    }
+    
+    // Far off (tempo jump, first ticks) snaps, otherwise a quarter of the
+    // error is corrected on each step. Late steps are never pushed back
+    // before now.
+    const double correction = fabs(phase) > _mesureTime * 0.25 ?
+                              phase : phase * 0.25;
+    _timeCount = std::max(0.0, _timeCount + correction);
+}
+
+void MySynthVoice::NoteOn(const int& note, const bool& accent)
+{
+    _pitchTarget = (float)std::max((int)MyPitchTable::MIN_NOTE,
+                                   std::min(note, (int)MyPitchTable::MAX_NOTE));
+    
+    if(!_keyHeld)
+    {
+        _pitch = _pitchTarget;
+        _decayIndex = 0.0;
+        _accentLevel = accent ? _accent : 0.0;
+    }
+    
+    _keyHeld = true;
+    _liveNote = note;
+    _envHold = true;
+}
+
+void MySynthVoice::NoteOff(const int& note)
+{
+    if(_keyHeld && note == _liveNote)
+    {
+        _keyHeld = false;
+        _envHold = false;
+    }
+}
+
+void MySynthVoice::UpdateTimeConstants()
+{
+    double stepTime = _sampleRate * 60.0 / (_bpm * 4.0);
+    
+    // Keep the current position inside the step.
+    _timeCount *= stepTime / _mesureTime;
+    _mesureTime = stepTime;
+    
+    UpdateDecayTime();
+    
+    // 0.45 ms click free attack ramp.
+    _attackTime = 0.00045 * _sampleRate;
+    
+    // Slide reaches 95% of the interval in about 60 ms.
+    _glideCoef = (float)exp(-1.0 / (0.02 * _sampleRate));
+    
+    // The accent capacitor charges with a 50 ms time constant, slow enough
+    // that consecutive accents build up on each other.
+    _accentCapCoef = (float)(1.0 - exp(-1.0 / (0.05 * _sampleRate *
+                                              _oversampling)));
+    
+    _cutoffOffset.SetSampleRate(_sampleRate * _oversampling);
+    _res.SetSampleRate(_sampleRate * _oversampling);
+    _tuningRatio.SetSampleRate(_sampleRate);
+    _volume.SetSampleRate(_sampleRate);
+    
+    UpdateFilterFreq();
+}
+
+void MySynthVoice::UpdateDecayTime()
+{
+    // Decay from a sixteenth to half a second.
+    _decayTime = _sampleRate / 16.0 + _decay * (_sampleRate / 2.0 -
+                                                _sampleRate / 16.0);
+}
+
+void MySynthVoice::UpdateFilterFreq()
+{
+    _filter.SetFreq(_filterFreq);
+}
+
+void MySynthVoice::NextPattern()
+{
+    if(_songMode)
+    {
+        _chainPos = (_chainPos + 1) % _bank.GetChainLength();
+        _pattern = _bank.GetPattern(_bank.GetChainEntry(_chainPos));
+    }
+    else
+    {
+        _pattern = _cuedPattern;
+    }
+}
+
+void MySynthVoice::TriggerStep(const unsigned long long& frame)
+{
+    // Pattern boundary. Also catches a pattern shortened under the
+    // current step.
+    if(_mesureCount >= _pattern->length)
+    {
+        _mesureCount = 0;
+        NextPattern();
+    }
+    
+    const Note& note = _pattern->notes[_mesureCount];
+    
+    const StepEvent event = { frame, (int)(_pattern - _bank.GetPattern(0)),
+                              _mesureCount, note };
+    _stepEvents->Push(event);
+    
+    ApplyAutomation(_mesureCount);
+    
+    if(note.on)
+    {
+        _pitchTarget = static_cast<float>(note.note + (note.up ? 12 : 0) -
+                                          (note.down ? 12 : 0));
+        
+        // A slide on the previous step glides into this one without
+        // retriggering the envelopes.
+        if(!_slideFromPrevious)
+        {
+            _pitch = _pitchTarget;
+            _decayIndex = 0.0;
+            _accentLevel = note.accent ? _accent : 0.0;
+        }
+        
+        // The gate stays open through a slid note.
+        _envHold = note.slide;
+        _slideFromPrevious = note.slide;
+    }
+    else
+    {
+        _envHold = false;
+        _slideFromPrevious = false;
+    }
+    
+    ++_mesureCount;
+}
+
+void MySynthVoice::ApplyAutomation(const int& step)
+{
+    // Lands on the first sample of the step, the cutoff and resonance
+    // glides keep it click free.
+    const MyPatternBank::Automation& automation = _pattern->automation;
+    const unsigned long long bit = 1ULL << step;
+    
+    for(int lane = 0; lane < MyPatternBank::NUM_LANES; lane++)
+    {
+        if(!(automation.mask[lane] & bit))
+        {
+            continue;
+        }
+        
+        const double value = MyPatternBank::DecodeLane(
+            lane, automation.values[lane][step]);
+        
+        switch(lane)
+        {
+            case MyPatternBank::CUTOFF: SetFilterFreq(value); break;
+            case MyPatternBank::RES: SetFilterRes(value); break;
+            case MyPatternBank::ENV_MOD: SetEnvMod(value); break;
+            case MyPatternBank::DECAY: SetDecay(value); break;
+            case MyPatternBank::ACCENT: SetAccent(value); break;
+        }
+    }
+}
+
+void MySynthVoice::Process(float* output, const unsigned long& frameCount)
+{
+    // Split the block at the exact sample where each step starts. _timeCount
+    // keeps the fractional part so the grid never drifts, whatever the
+    // buffer size.
+    unsigned long frame = 0;
+    
+    while(frame < frameCount)
+    {
+        if(_timeCount <= 0.0)
+        {
+            if(_playing)
+            {
+                TriggerStep(_frame + frame);
+            }
+            
+            _timeCount += _mesureTime;
+        }
+        
+        unsigned long n = std::min<unsigned long>(frameCount - frame,
+                                                  ceil(_timeCount));
+        
+        ProcessFrames(output + frame, n);
+        
+        frame += n;
+        _timeCount -= n;
+    }
+    
+    _frame += frameCount;
+}
+
+void MySynthVoice::ProcessFrames(float* output,
+                                 const unsigned long& frameCount)
+{
+    unsigned long frame = 0;
+    
+    while(frame < frameCount)
+    {
+        unsigned long n = std::min<unsigned long>(frameCount - frame,
+                                                  CHUNK_FRAMES);
+        ProcessChunk(output + frame, n);
+        frame += n;
+    }
+}
+
+void MySynthVoice::RenderPitch(const unsigned long& frameCount)
+{
+    // Exponential glide in the semitone domain, converted to Hz through the
+    // pitch table every frame.
+    if(_pitch == _pitchTarget)
+    {
+        std::fill(_freqBuffer, _freqBuffer + frameCount,
+                  _pitchTable.GetFreq(_pitch));
+        return;
+    }
+    
+    const float target = _pitchTarget;
+    const float coef = _glideCoef;
+    float pitch = _pitch;
+    
+    for(unsigned long i = 0; i < frameCount; i++)
+    {
+        pitch = target + (pitch - target) * coef;
+        _freqBuffer[i] = _pitchTable.GetFreq(pitch);
+    }
+    
+    _pitch = fabsf(pitch - target) < 0.005f ? target : pitch;
+}
+
+void MySynthVoice::ProcessChunk(float* output,
+                                const unsigned long& frameCount)
+{
+    // Oscillator and filter run at the oversampled rate, the result is
+    // decimated back before the envelope.
+    const unsigned long osFrames = frameCount * _oversampling;
+    float* mono = _oversampling > 1 ? _osBuffer : output;
+    
+    const float start = (float)(_decayIndex + 1.0);
+    const float invAttack = (float)(1.0 / _attackTime);
+    const float invDecay = (float)(1.0 / _decayTime);
+    
+    // A held gate stops the envelopes right after the attack.
+    const float holdPoint = (float)(_attackTime * 1.5);
+    const float end = _envHold ? std::max(holdPoint, start) : (float)_sampleRate;
+    
+    double time = _profiling ? MyProfiler::Now() : 0.0;
+    
+    // The pitch path is per frame at the base rate, each value is held for
+    // the oversampled frames.
+    RenderPitch(frameCount);
+    
+    if(_tuningRatio.Process(_rampBuffer, frameCount))
+    {
+        MyApplyGain(_freqBuffer, _rampBuffer, frameCount);
+    }
+    
+    _osc.ProcessBlock(mono, _freqBuffer, frameCount, _oversampling);
+    Lap(MyProfiler::OSCILLATOR, time);
+    
+    // Cutoff modulation in octaves at the oversampled rate : decay envelope
+    // times ENV MOD, plus the accent sweep. The accent capacitor is a one
+    // pole following the accented envelope. Null while there is none.
+    const float* mod = nullptr;
+    
+    if(_envMod > 0.0 || _accentLevel > 0.0 || _accentCap > 0.0001f)
+    {
+        const float os = (float)_oversampling;
+        const float envOctaves = (float)_envMod * ENV_MOD_OCTAVES;
+        const float level = (float)_accentLevel;
+        const float k = _accentCapCoef;
+        float cap = _accentCap;
+        
+        MyEnvelopeBlock(_modBuffer, osFrames, start, 1.0f / os, end,
+                        invAttack, invDecay, 1.0f);
+        
+        for(unsigned long i = 0; i < osFrames; i++)
+        {
+            const float e = _modBuffer[i];
+            cap += (level * e - cap) * k;
+            _modBuffer[i] = e * envOctaves + cap * ACCENT_OCTAVES;
+        }
+        
+        _accentCap = cap;
+        mod = _modBuffer;
+    }
+    
+    // Knob glides only cost anything while they move.
+    if(_cutoffOffset.Process(_cutoffBuffer, osFrames))
+    {
+        if(mod)
+        {
+            MyAccumulate(_modBuffer, _cutoffBuffer, osFrames);
+        }
+        else
+        {
+            mod = _cutoffBuffer;
+        }
+    }
+    
+    if(_res.Process(_resBuffer, osFrames))
+    {
+        if(!mod)
+        {
+            std::fill(_cutoffBuffer, _cutoffBuffer + osFrames, 0.0f);
+            mod = _cutoffBuffer;
+        }
+        
+        _filter.ProcessBlock(mono, mod, _resBuffer, osFrames);
+    }
+    else if(mod)
+    {
+        _filter.ProcessBlock(mono, mod, osFrames);
+    }
+    else
+    {
+        _filter.ProcessBlock(mono, osFrames);
+    }
+    
+    Lap(MyProfiler::FILTER, time);
+    
+    if(_oversampling > 1)
+    {
+        _decimator.Process(mono, frameCount, 1);
+        std::copy(mono, mono + frameCount, output);
+        Lap(MyProfiler::DECIMATOR, time);
+    }
+    
+    // Envelope and volume for the whole chunk, then one multiply pass.
+    // Accented notes are louder.
+    const double accentGain = 1.0 + ACCENT_GAIN * _accentLevel;
+    
+    if(_volume.Process(_rampBuffer, frameCount))
+    {
+        MyEnvelopeBlock(_envBuffer, frameCount, start, 1.0f, end,
+                        invAttack, invDecay, (float)accentGain);
+        MyApplyGain(_envBuffer, _rampBuffer, frameCount);
+    }
+    else
+    {
+        MyEnvelopeBlock(_envBuffer, frameCount, start, 1.0f, end,
+                        invAttack, invDecay,
+                        (float)(_volume.GetValue() * accentGain));
+    }
+    
+    MyApplyGain(output, _envBuffer, frameCount);
+    Lap(MyProfiler::ENVELOPE, time);
+    
+    // Past the longest decay the envelope is silent anyway, stop counting so
+    // the float ramp keeps its precision.
+    _decayIndex = std::min(_decayIndex + frameCount, (double)end);
+}
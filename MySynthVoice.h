@@ -0,0 +1,276 @@
+#ifndef __MY_SYNTH_VOICE__
+#define __MY_SYNTH_VOICE__
+
+#include "MyDecimator.h"
+#include "MyLockFreeQueue.h"
+#include "MyOscillator.h"
+#include "MyPatternBank.h"
+#include "MyPitchTable.h"
+#include "MyPresetFile.h"
+#include "MyProfiler.h"
+#include "MySmoother.h"
+#include "MyTB303Filter.h"
+
+/// One 303 line : step sequencer, oscillator, filter and envelope.
+/// Device independent, it only renders into the buffers it is given, so it
+/// can run inside the audio callback or offline. Not thread safe, all calls
+/// must come from the thread that renders.
+class MySynthVoice
+{
+public:
+    MySynthVoice(const double& sampleRate = 44100.0);
+    ~MySynthVoice();
+    
+    typedef MyPatternBank::Note Note;
+    
+    static constexpr float ENV_MOD_OCTAVES = 5.0f;
+    static constexpr float ACCENT_OCTAVES = 2.0f;
+    static constexpr float ACCENT_GAIN = 0.5f;
+    
+    void SetSampleRate(const double& sampleRate);
+    
+    double GetSampleRate() const
+    {
+        return _sampleRate;
+    }
+    
+    /// Runs the oscillator and filter at 1, 2, 4 or 8 times the sample rate.
+    void SetOversampling(const int& factor);
+    
+    /// Tempo in beats per minute, one step per sixteenth note.
+    void SetBpm(const double& bpm);
+    
+    /// Step length in samples (fractional).
+    double GetStepLength() const
+    {
+        return _mesureTime;
+    }
+    
+    void SetWaveformType(const MyOscillator::Waveform& type);
+    
+    /// Duty cycle of the PULSE waveform, from 0.05 to 0.95.
+    void SetPulseWidth(const double& width);
+    
+    /// Cutoff, resonance, volume and tuning glide to their new value over
+    /// a few ms (see MySmoother) rather than jumping.
+    void SetFilterFreq(const double& freq);
+    
+    /// Resonance from 0 to 1.
+    void SetFilterRes(const double& res);
+    
+    /// Envelope to cutoff amount from 0 to 1 (up to ENV_MOD_OCTAVES).
+    void SetEnvMod(const double& envMod);
+    
+    /// Accent amount from 0 to 1.
+    void SetAccent(const double& accent);
+    void SetVolume(const double& volume);
+    void SetDecay(const double& decay);
+    void SetTuning(const double& tune);
+    
+    /// Cents offset of each of the 12 pitch classes, nullptr for equal
+    /// temperament.
+    void SetScale(const double* cents);
+    
+    void SetNote(const int& pattern, const int& index, const Note& note);
+    
+    const Note& GetNote(const int& pattern, const int& index) const
+    {
+        return _bank.GetPattern(pattern)->notes[index];
+    }
+    
+    /// From 1 to MyPatternBank::MAX_STEPS.
+    void SetPatternLength(const int& pattern, const int& length);
+    
+    int GetPatternLength(const int& pattern) const
+    {
+        return _bank.GetPattern(pattern)->length;
+    }
+    
+    /// Knob value of a MyPatternBank::Lane at a step, applied when the
+    /// step starts.
+    void SetAutomation(const int& pattern,
+                       const int& step,
+                       const int& lane,
+                       const double& value);
+    
+    void ClearAutomation(const int& pattern);
+    
+    /// Pattern played once the current one reaches its last step, or right
+    /// away after a Reset.
+    void SelectPattern(const int& pattern);
+    
+    /// Pattern playing now.
+    int GetPatternIndex() const
+    {
+        return static_cast<int>(_pattern - _bank.GetPattern(0));
+    }
+    
+    /// Step of it playing now, -1 before the first one.
+    int GetStep() const
+    {
+        return _mesureCount - 1;
+    }
+    
+    void SetChainEntry(const int& index, const int& pattern);
+    void SetChainLength(const int& length);
+    
+    /// Song mode plays the chain in order instead of the selected pattern.
+    void SetSongMode(const bool& song);
+    
+    /// Transport of an external clock. Start plays the first step of the
+    /// pattern (or chain) right away, stopping only lets the note decay.
+    void Start();
+    void SetPlaying(const bool& playing);
+    
+    bool IsPlaying() const
+    {
+        return _playing;
+    }
+    
+    /// Called on the clock tick that should start a step. Pulls the step
+    /// grid part of the way towards it so a jittery clock doesn't move the
+    /// notes around.
+    void SyncStep();
+    
+    /// Live notes in semitones like Note::note, octaves included. A note
+    /// played while another is held slides to it without retriggering.
+    void NoteOn(const int& note, const bool& accent);
+    void NoteOff(const int& note);
+    
+    /// Every knob, and the preset's steps copied into pattern.
+    void SetPreset(const MyPreset& preset, const int& pattern);
+    
+    /// Accumulates the time spent in each MyProfiler::Stage.
+    void SetProfiling(const bool& profiling);
+    
+    /// Seconds per stage since the last ResetStageTimes.
+    const double* GetStageTimes() const
+    {
+        return _stageTimes;
+    }
+    
+    void ResetStageTimes();
+    
+    /// Published by the audio thread when a step starts.
+    struct StepEvent
+    {
+        unsigned long long frame; // Since the last Reset, exact to the sample.
+        int pattern;
+        int step;
+        Note note; // note.on is the gate.
+    };
+    
+    /// Oldest unread step, for one thread other than the audio one. Events
+    /// are dropped while the ring is full.
+    bool PopStepEvent(StepEvent& event)
+    {
+        return _stepEvents->Pop(event);
+    }
+    
+    /// Ends every knob glide on its target.
+    void SettleParameters();
+    
+    /// Back to the first step with a silent envelope, knobs settled.
+    void Reset();
+    
+    /// Renders frameCount mono frames, the voice is mono all the way
+    /// through. Fanning out to the device channels is left to the caller.
+    void Process(float* output, const unsigned long& frameCount);
+    
+private:
+    MyOscillator _osc;
+    MyTB303Filter _filter;
+    
+    void TriggerStep(const unsigned long long& frame);
+    void ApplyAutomation(const int& step);
+    void NextPattern();
+    void RenderPitch(const unsigned long& frameCount);
+    void ProcessFrames(float* output, const unsigned long& frameCount);
+    void ProcessChunk(float* output, const unsigned long& frameCount);
+    
+    void UpdateTimeConstants();
+    void UpdateDecayTime();
+    
+    inline void Lap(const int& stage, double& time)
+    {
+        if(_profiling)
+        {
+            const double now = MyProfiler::Now();
+            _stageTimes[stage] += now - time;
+            time = now;
+        }
+    }
+    void UpdateFilterFreq();
+    
+    // Frames rendered at once in the oversampled buffer.
+    static const int CHUNK_FRAMES = 256;
+    
+    MyPitchTable _pitchTable;
+    
+    double _sampleRate;
+    int _oversampling;
+    MyDecimator _decimator;
+    float* _osBuffer;
+    float _envBuffer[CHUNK_FRAMES];
+    float _freqBuffer[CHUNK_FRAMES]; // Oscillator Hz per frame.
+    float* _modBuffer;
+    float _rampBuffer[CHUNK_FRAMES];
+    float* _cutoffBuffer;
+    float* _resBuffer;
+    
+    // The audio thread only moves pointers into the bank, patterns are
+    // never copied while playing.
+    MyPatternBank _bank;
+    const MyPatternBank::Pattern* _pattern;
+    const MyPatternBank::Pattern* _cuedPattern;
+    bool _songMode;
+    int _chainPos;
+    
+    // Audio thread -> GUI.
+    MyLockFreeQueue<StepEvent, 256>* _stepEvents;
+    unsigned long long _frame; // Frames rendered since Reset.
+    
+    bool _playing;
+    bool _keyHeld;
+    int _liveNote;
+    
+    double _bpm;
+    int _mesureCount;
+    double _mesureTime; // Step length in samples (fractional).
+    double _timeCount; // Samples left before the next step starts.
+    
+    double _decay;
+    double _decayTime;
+    double _decayIndex;
+    double _attackTime;
+    
+    // Oscillator pitch in semitones (see MyPitchTable), gliding towards
+    // _pitchTarget.
+    float _pitch;
+    float _pitchTarget;
+    float _glideCoef; // Per frame.
+    bool _slideFromPrevious;
+    bool _envHold;
+    
+    double _filterFreq;
+    double _envMod;
+    
+    // The filter and the pitch table jump to a new cutoff or tuning, these
+    // glide from the old one back to 0 octaves and a ratio of 1. Cutoff and
+    // resonance run at the oversampled rate.
+    MySmoother _cutoffOffset;
+    MySmoother _res;
+    MySmoother _tuningRatio;
+    
+    double _accent;
+    double _accentLevel; // Accent of the note playing.
+    float _accentCap;
+    float _accentCapCoef;
+    
+    MySmoother _volume;
+    
+    bool _profiling;
+    double _stageTimes[MyProfiler::NUM_STAGES];
+};
+
+#endif // __MY_SYNTH_VOICE__
@@ -0,0 +1,180 @@
+#include "MyTB303Filter.h"
+#include <algorithm>
+#include <cmath>
+
+// Stage gain table, G = g / (1 + g) with g = tan(pi * fc / fs), over
+// pitch = log2(fc / fs) from PITCH_MIN (~2.7 Hz at 44.1 kHz) to just below
+// Nyquist.
+static const float PITCH_MIN = -14.0f;
+static const float PITCH_MAX = -1.03f;
+static const int GAIN_TABLE_SIZE = 2048;
+
+// Feedback at full resonance. Self oscillation starts at 4, the saturation
+// keeps it tame.
+static const float MAX_FEEDBACK = 4.2f;
+
+// Built on first use whatever the static initialization order. The filter
+// constructor gets there first, never the audio thread.
+static const float* GetGainTable()
+{
+    struct Table
+    {
+        Table()
+        {
+            for(int i = 0; i <= GAIN_TABLE_SIZE; i++)
+            {
+                double pitch = PITCH_MIN + (PITCH_MAX - PITCH_MIN) * i /
+                               GAIN_TABLE_SIZE;
+                double g = tan(M_PI * pow(2.0, pitch));
+                values[i] = (float)(g / (1.0 + g));
+            }
+        }
+        
+        float values[GAIN_TABLE_SIZE + 1];
+    };
+    
+    static const Table table;
+    return table.values;
+}
+
+static inline float SoftClip(const float& x)
+{
+    // Pade approximation of tanh, exact at +-3.
+    const float c = std::max(-3.0f, std::min(x, 3.0f));
+    return c * (27.0f + c * c) / (27.0f + 9.0f * c * c);
+}
+
+/*******************************************************************************
+ * MyTB303Filter.
+ ******************************************************************************/
+MyTB303Filter::MyTB303Filter():
+_sampleRate(44100.0),
+_freq(20000.0),
+_k(0.0f)
+{
+    Reset();
+    SetSampleRate(44100.0);
+}
+
+void MyTB303Filter::SetSampleRate(const double& sampleRate)
+{
+    _sampleRate = sampleRate;
+    
+    double g = tan(M_PI * 150.0 / _sampleRate);
+    _hpG = (float)(g / (1.0 + g));
+    
+    SetFreq(_freq);
+}
+
+void MyTB303Filter::SetFreq(const double& freq)
+{
+    _freq = freq;
+    _pitch = (float)log2(std::max(freq, 1.0) / _sampleRate);
+    _G = GetStageGain(GetGainTable(), _pitch);
+}
+
+void MyTB303Filter::SetRes(const double& res)
+{
+    _k = MAX_FEEDBACK * (float)std::max(0.0, std::min(res, 1.0));
+}
+
+void MyTB303Filter::Reset()
+{
+    _s1 = _s2 = _s3 = _s4 = _sh = 0.0f;
+}
+
+float MyTB303Filter::GetStageGain(const float* table,
+                                  const float& pitch) const
+{
+    const float p = std::max(PITCH_MIN, std::min(pitch, PITCH_MAX));
+    const float pos = (p - PITCH_MIN) * (GAIN_TABLE_SIZE /
+                                         (PITCH_MAX - PITCH_MIN));
+    const int i = std::min((int)pos, GAIN_TABLE_SIZE - 1);
+    const float frac = pos - (float)i;
+    
+    return table[i] + frac * (table[i + 1] - table[i]);
+}
+
+float MyTB303Filter::ProcessSample(const float& x,
+                                   const float& G,
+                                   const float& k)
+{
+    // Every stage is y = G * in + S with S = s * (1 - G). Solve the loop
+    // through the feedback highpass for y4, then saturate the input.
+    const float oneMinusG = 1.0f - G;
+    const float S1 = _s1 * oneMinusG, S2 = _s2 * oneMinusG;
+    const float S3 = _s3 * oneMinusG, S4 = _s4 * oneMinusG;
+    const float G2 = G * G;
+    const float G4 = G2 * G2;
+    const float sum = G2 * G * S1 + G2 * S2 + G * S3 + S4;
+    
+    const float Sh = _sh * (1.0f - _hpG);
+    const float hpGain = 1.0f - _hpG;
+    
+    float y4 = (G4 * (x + k * Sh) + sum) / (1.0f + k * G4 * hpGain);
+    
+    const float u = SoftClip(x - k * (hpGain * y4 - Sh));
+    
+    // Run the stages with the saturated input and update the states.
+    float v = (u - _s1) * G;
+    const float y1 = v + _s1;
+    _s1 = y1 + v;
+    
+    v = (y1 - _s2) * G;
+    const float y2 = v + _s2;
+    _s2 = y2 + v;
+    
+    v = (y2 - _s3) * G;
+    const float y3 = v + _s3;
+    _s3 = y3 + v;
+    
+    v = (y3 - _s4) * G;
+    y4 = v + _s4;
+    _s4 = y4 + v;
+    
+    // Feedback highpass state follows the lowpass part of y4.
+    v = (y4 - _sh) * _hpG;
+    _sh = v + _sh + v;
+    
+    // Some passband make up when the resonance is up.
+    return y4 * (1.0f + 0.3f * k);
+}
+
+void MyTB303Filter::ProcessBlock(float* buffer,
+                                 const unsigned long& frameCount)
+{
+    const float G = _G;
+    
+    for(unsigned long i = 0; i < frameCount; i++)
+    {
+        buffer[i] = ProcessSample(buffer[i], G, _k);
+    }
+}
+
+void MyTB303Filter::ProcessBlock(float* buffer,
+                                 const float* mod,
+                                 const unsigned long& frameCount)
+{
+    const float* table = GetGainTable();
+    
+    for(unsigned long i = 0; i < frameCount; i++)
+    {
+        buffer[i] = ProcessSample(buffer[i],
+                                  GetStageGain(table, _pitch + mod[i]), _k);
+    }
+}
+
+void MyTB303Filter::ProcessBlock(float* buffer,
+                                 const float* mod,
+                                 const float* res,
+                                 const unsigned long& frameCount)
+{
+    const float* table = GetGainTable();
+    
+    for(unsigned long i = 0; i < frameCount; i++)
+    {
+        buffer[i] = ProcessSample(buffer[i],
+                                  GetStageGain(table, _pitch + mod[i]),
+                                  MAX_FEEDBACK * res[i]);
+    }
+}
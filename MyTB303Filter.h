@@ -0,0 +1,57 @@
+#ifndef __MY_TB303_FILTER__
+#define __MY_TB303_FILTER__
+
+/// 303 style 4-pole ladder lowpass.
+/// Zero delay feedback cascade of four one-pole stages, the feedback path
+/// goes through a 150 Hz highpass (like the 303, resonance doesn't thin out
+/// the bass) and a soft saturation standing in for the diodes.
+///
+/// The cutoff is kept as a pitch, log2(freq / sampleRate), and the stage gain
+/// is read from a shared table, so modulating it per sample costs a lookup
+/// instead of a tan() and a coefficient update.
+class MyTB303Filter
+{
+public:
+    MyTB303Filter();
+    
+    void SetSampleRate(const double& sampleRate);
+    
+    /// Base cutoff in Hz.
+    void SetFreq(const double& freq);
+    
+    /// Resonance from 0 to 1.
+    void SetRes(const double& res);
+    
+    void Reset();
+    
+    /// Fixed cutoff.
+    void ProcessBlock(float* buffer, const unsigned long& frameCount);
+    
+    /// Per sample cutoff, mod[i] in octaves above the base cutoff.
+    void ProcessBlock(float* buffer,
+                      const float* mod,
+                      const unsigned long& frameCount);
+    
+    /// Per sample cutoff and resonance, res[i] from 0 to 1 instead of the
+    /// SetRes value.
+    void ProcessBlock(float* buffer,
+                      const float* mod,
+                      const float* res,
+                      const unsigned long& frameCount);
+                      
+private:
+    inline float ProcessSample(const float& x, const float& G, const float& k);
+    inline float GetStageGain(const float* table, const float& pitch) const;
+    
+    double _sampleRate;
+    double _freq;
+    float _pitch;
+    float _G;
+    float _k;
+    float _hpG;
+    
+    // Integrator states of the four stages and the feedback highpass.
+    float _s1, _s2, _s3, _s4, _sh;
+};
+
+#endif // __MY_TB303_FILTER__
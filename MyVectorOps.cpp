@@ -0,0 +1,193 @@
+#include "MyVectorOps.h"
+#include <algorithm>
+
+#ifdef MY_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+void MyEnvelopeBlock(float* env,
+                     const unsigned long& frameCount,
+                     const float& start,
+                     const float& step,
+                     const float& end,
+                     const float& invAttack,
+                     const float& invDecay,
+                     const float& gain)
+{
+    unsigned long i = 0;
+
+#ifdef MY_USE_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 step4 = _mm_set1_ps(4.0f * step);
+    const __m128 e = _mm_set1_ps(end);
+    const __m128 a = _mm_set1_ps(invAttack);
+    const __m128 d = _mm_set1_ps(invDecay);
+    const __m128 g = _mm_set1_ps(gain);
+    __m128 pos = _mm_setr_ps(start, start + step,
+                             start + 2.0f * step, start + 3.0f * step);
+    
+    for(; i + 4 <= frameCount; i += 4)
+    {
+        const __m128 x = _mm_min_ps(pos, e);
+        __m128 v = _mm_min_ps(_mm_mul_ps(x, a),
+                              _mm_sub_ps(one, _mm_mul_ps(x, d)));
+        v = _mm_min_ps(_mm_max_ps(v, zero), one);
+        _mm_storeu_ps(env + i, _mm_mul_ps(v, g));
+        pos = _mm_add_ps(pos, step4);
+    }
+#endif
+
+    for(; i < frameCount; i++)
+    {
+        float x = start + (float)i * step;
+        x = x < end ? x : end;
+        const float atk = x * invAttack;
+        const float dec = 1.0f - x * invDecay;
+        float v = atk < dec ? atk : dec;
+        v = v < 0.0f ? 0.0f : v;
+        v = v > 1.0f ? 1.0f : v;
+        env[i] = v * gain;
+    }
+}
+
+void MyApplyGain(float* buffer,
+                 const float* gain,
+                 const unsigned long& frameCount)
+{
+    unsigned long i = 0;
+
+#ifdef MY_USE_SSE
+    for(; i + 4 <= frameCount; i += 4)
+    {
+        _mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_loadu_ps(buffer + i),
+                                             _mm_loadu_ps(gain + i)));
+    }
+#endif
+
+    for(; i < frameCount; i++)
+    {
+        buffer[i] *= gain[i];
+    }
+}
+
+void MyAccumulate(float* output,
+                  const float* input,
+                  const unsigned long& frameCount)
+{
+    unsigned long i = 0;
+
+#ifdef MY_USE_SSE
+    for(; i + 4 <= frameCount; i += 4)
+    {
+        _mm_storeu_ps(output + i, _mm_add_ps(_mm_loadu_ps(output + i),
+                                             _mm_loadu_ps(input + i)));
+    }
+#endif
+
+    for(; i < frameCount; i++)
+    {
+        output[i] += input[i];
+    }
+}
+
+void MyLinearRamp(float* buffer,
+                  const unsigned long& frameCount,
+                  const float& start,
+                  const float& step)
+{
+    unsigned long i = 0;
+
+#ifdef MY_USE_SSE
+    const __m128 step4 = _mm_set1_ps(4.0f * step);
+    __m128 x = _mm_setr_ps(start + step, start + 2.0f * step,
+                           start + 3.0f * step, start + 4.0f * step);
+    
+    for(; i + 4 <= frameCount; i += 4)
+    {
+        _mm_storeu_ps(buffer + i, x);
+        x = _mm_add_ps(x, step4);
+    }
+#endif
+
+    for(; i < frameCount; i++)
+    {
+        buffer[i] = start + (float)(i + 1) * step;
+    }
+}
+
+void MyExpRamp(float* buffer,
+               const unsigned long& frameCount,
+               const float& target,
+               const float& delta,
+               const float& coef)
+{
+    // The recursion is unrolled four frames at a time : each lane carries
+    // its own power of coef and all of them advance by coef^4.
+    unsigned long i = 0;
+    float d = delta;
+
+#ifdef MY_USE_SSE
+    const float c2 = coef * coef;
+    const float c4 = c2 * c2;
+    const __m128 t = _mm_set1_ps(target);
+    const __m128 k = _mm_set1_ps(c4);
+    __m128 x = _mm_mul_ps(_mm_set1_ps(delta),
+                          _mm_setr_ps(coef, c2, c2 * coef, c4));
+    
+    for(; i + 4 <= frameCount; i += 4)
+    {
+        _mm_storeu_ps(buffer + i, _mm_add_ps(t, x));
+        x = _mm_mul_ps(x, k);
+    }
+    
+    d = i ? buffer[i - 1] - target : delta;
+#endif
+
+    for(; i < frameCount; i++)
+    {
+        d *= coef;
+        buffer[i] = target + d;
+    }
+}
+
+void MyFanOut(const float* mono,
+              float* output,
+              const unsigned long& frameCount,
+              const int& numChannels)
+{
+    if(numChannels == 1)
+    {
+        std::copy(mono, mono + frameCount, output);
+        return;
+    }
+    
+    unsigned long i = 0;
+    
+    if(numChannels == 2)
+    {
+#ifdef MY_USE_SSE
+        for(; i + 4 <= frameCount; i += 4)
+        {
+            const __m128 m = _mm_loadu_ps(mono + i);
+            _mm_storeu_ps(output + i * 2, _mm_unpacklo_ps(m, m));
+            _mm_storeu_ps(output + i * 2 + 4, _mm_unpackhi_ps(m, m));
+        }
+#endif
+
+        for(; i < frameCount; i++)
+        {
+            output[i * 2] = output[i * 2 + 1] = mono[i];
+        }
+        
+        return;
+    }
+    
+    for(; i < frameCount; i++)
+    {
+        for(int c = 0; c < numChannels; c++)
+        {
+            output[i * numChannels + c] = mono[i];
+        }
+    }
+}
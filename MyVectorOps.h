@@ -0,0 +1,53 @@
+#ifndef __MY_VECTOR_OPS__
+#define __MY_VECTOR_OPS__
+
+// Block helpers for the voice hot loop. Branch free, with an SSE path where
+// available; the scalar fallback is written so compilers can auto-vectorize
+// it (NEON on ARM).
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MY_USE_SSE 1
+#endif
+
+/// Attack / decay envelope scaled by gain. Sample i is computed at position
+/// x = min(start + i * step, end) : min(x / attack, 1 - x / decay) clamped
+/// to [0, 1]. end holds the envelope at a given point, step < 1 renders it
+/// at a higher rate.
+void MyEnvelopeBlock(float* env,
+                     const unsigned long& frameCount,
+                     const float& start,
+                     const float& step,
+                     const float& end,
+                     const float& invAttack,
+                     const float& invDecay,
+                     const float& gain);
+
+/// buffer[i] *= gain[i].
+void MyApplyGain(float* buffer,
+                 const float* gain,
+                 const unsigned long& frameCount);
+
+/// output[i] += input[i].
+void MyAccumulate(float* output,
+                  const float* input,
+                  const unsigned long& frameCount);
+
+/// Linear ramp : buffer[i] = start + (i + 1) * step.
+void MyLinearRamp(float* buffer,
+                  const unsigned long& frameCount,
+                  const float& start,
+                  const float& step);
+
+/// One pole glide : buffer[i] = target + delta * coef^(i + 1).
+void MyExpRamp(float* buffer,
+               const unsigned long& frameCount,
+               const float& target,
+               const float& delta,
+               const float& coef);
+
+/// Copies a mono signal to every channel of an interleaved output.
+void MyFanOut(const float* mono,
+              float* output,
+              const unsigned long& frameCount,
+              const int& numChannels);
+
+#endif // __MY_VECTOR_OPS__
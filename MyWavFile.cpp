@@ -0,0 +1,274 @@
+#include "MyWavFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static void PutLE16(unsigned char* p, const unsigned int& v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void PutLE32(unsigned char* p, const unsigned int& v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+static unsigned int GetLE16(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static unsigned int GetLE32(const unsigned char* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+/*******************************************************************************
+ * MyWavWriter.
+ ******************************************************************************/
+MyWavWriter::MyWavWriter():
+_file(nullptr),
+_format(PCM_16),
+_numChannels(2),
+_sampleRate(44100),
+_frameCount(0)
+{
+
+}
+
+MyWavWriter::~MyWavWriter()
+{
+    Close();
+}
+
+bool MyWavWriter::Open(const std::string& path,
+                       const double& sampleRate,
+                       const int& numChannels,
+                       const Format& format)
+{
+    Close();
+    
+    _file = fopen(path.c_str(), "wb");
+    
+    if(_file == nullptr)
+    {
+        return false;
+    }
+    
+    _format = format;
+    _numChannels = numChannels;
+    _sampleRate = static_cast<int>(sampleRate + 0.5);
+    _frameCount = 0;
+    
+    // Placeholder, rewritten with the real sizes on Close.
+    WriteHeader();
+    return true;
+}
+
+void MyWavWriter::WriteHeader()
+{
+    const int bytesPerSample = _format == PCM_16 ? 2 : (_format == PCM_24 ? 3 : 4);
+    const unsigned int blockAlign = bytesPerSample * _numChannels;
+    const unsigned int dataBytes = static_cast<unsigned int>(_frameCount *
+                                                             blockAlign);
+    
+    unsigned char h[44];
+    memcpy(h, "RIFF", 4);
+    PutLE32(h + 4, 36 + dataBytes);
+    memcpy(h + 8, "WAVE", 4);
+    memcpy(h + 12, "fmt ", 4);
+    PutLE32(h + 16, 16);
+    PutLE16(h + 20, _format == FLOAT_32 ? 3 : 1);
+    PutLE16(h + 22, _numChannels);
+    PutLE32(h + 24, _sampleRate);
+    PutLE32(h + 28, _sampleRate * blockAlign);
+    PutLE16(h + 32, blockAlign);
+    PutLE16(h + 34, bytesPerSample * 8);
+    memcpy(h + 36, "data", 4);
+    PutLE32(h + 40, dataBytes);
+    
+    fseek(_file, 0, SEEK_SET);
+    fwrite(h, 1, sizeof(h), _file);
+}
+
+bool MyWavWriter::Write(const float* data, const unsigned long& frameCount)
+{
+    if(_file == nullptr)
+    {
+        return false;
+    }
+    
+    const int bytesPerSample = _format == PCM_16 ? 2 : (_format == PCM_24 ? 3 : 4);
+    const unsigned long numSamples = frameCount * _numChannels;
+    const unsigned long chunkSamples = BUFFER_BYTES / bytesPerSample;
+    
+    for(unsigned long done = 0; done < numSamples; done += chunkSamples)
+    {
+        const unsigned long n = std::min(chunkSamples, numSamples - done);
+        const float* in = data + done;
+        unsigned char* p = _buffer;
+        
+        switch(_format)
+        {
+            case PCM_16:
+                for(unsigned long i = 0; i < n; i++, p += 2)
+                {
+                    float v = std::max(-1.0f, std::min(in[i], 1.0f));
+                    PutLE16(p, static_cast<short>(lrintf(v * 32767.0f)));
+                }
+                break;
+            
+            case PCM_24:
+                for(unsigned long i = 0; i < n; i++, p += 3)
+                {
+                    float v = std::max(-1.0f, std::min(in[i], 1.0f));
+                    int s = static_cast<int>(lrintf(v * 8388607.0f));
+                    p[0] = s & 0xFF;
+                    p[1] = (s >> 8) & 0xFF;
+                    p[2] = (s >> 16) & 0xFF;
+                }
+                break;
+            
+            case FLOAT_32:
+                for(unsigned long i = 0; i < n; i++, p += 4)
+                {
+                    unsigned int bits;
+                    memcpy(&bits, in + i, 4);
+                    PutLE32(p, bits);
+                }
+                break;
+        }
+        
+        if(fwrite(_buffer, bytesPerSample, n, _file) != n)
+        {
+            return false;
+        }
+    }
+    
+    _frameCount += frameCount;
+    return true;
+}
+
+bool MyWavWriter::Close()
+{
+    if(_file == nullptr)
+    {
+        return false;
+    }
+    
+    WriteHeader();
+    bool ok = fclose(_file) == 0;
+    _file = nullptr;
+    return ok;
+}
+
+/*******************************************************************************
+ * MyWavReader.
+ ******************************************************************************/
+MyWavReader::MyWavReader():
+_numChannels(0),
+_sampleRate(0)
+{
+
+}
+
+bool MyWavReader::Read(const std::string& path)
+{
+    _data.clear();
+    _numChannels = 0;
+    
+    FILE* file = fopen(path.c_str(), "rb");
+    
+    if(file == nullptr)
+    {
+        return false;
+    }
+    
+    unsigned char h[12];
+    
+    if(fread(h, 1, 12, file) != 12 ||
+       memcmp(h, "RIFF", 4) != 0 || memcmp(h + 8, "WAVE", 4) != 0)
+    {
+        fclose(file);
+        return false;
+    }
+    
+    int format = 0, bits = 0;
+    
+    // Walks the chunks up to "data", skipping anything we don't know.
+    unsigned char chunk[8];
+    
+    while(fread(chunk, 1, 8, file) == 8)
+    {
+        const unsigned int size = GetLE32(chunk + 4);
+        
+        if(memcmp(chunk, "fmt ", 4) == 0 && size >= 16)
+        {
+            unsigned char f[16];
+            
+            if(fread(f, 1, 16, file) != 16)
+            {
+                break;
+            }
+            
+            format = GetLE16(f);
+            _numChannels = GetLE16(f + 2);
+            _sampleRate = GetLE32(f + 4);
+            bits = GetLE16(f + 14);
+            fseek(file, size - 16 + (size & 1), SEEK_CUR);
+        }
+        else if(memcmp(chunk, "data", 4) == 0)
+        {
+            const int bytesPerSample = bits / 8;
+            
+            if(_numChannels == 0 || !((format == 1 && (bits == 16 || bits == 24)) ||
+                                      (format == 3 && bits == 32)))
+            {
+                break;
+            }
+            
+            std::vector<unsigned char> raw(size);
+            const size_t got = fread(raw.data(), 1, size, file);
+            const unsigned long numSamples = got / bytesPerSample;
+            
+            _data.resize(numSamples - numSamples % _numChannels);
+            
+            for(unsigned long i = 0; i < _data.size(); i++)
+            {
+                const unsigned char* p = raw.data() + i * bytesPerSample;
+                
+                if(format == 3)
+                {
+                    unsigned int v = GetLE32(p);
+                    memcpy(&_data[i], &v, 4);
+                }
+                else if(bits == 16)
+                {
+                    _data[i] = (short)GetLE16(p) / 32767.0f;
+                }
+                else
+                {
+                    // Sign extends the 24 bit sample.
+                    int v = (int)((p[0] << 8) | (p[1] << 16) |
+                                  ((unsigned int)p[2] << 24)) >> 8;
+                    _data[i] = v / 8388607.0f;
+                }
+            }
+            
+            fclose(file);
+            return true;
+        }
+        else
+        {
+            fseek(file, size + (size & 1), SEEK_CUR);
+        }
+    }
+    
+    fclose(file);
+    _numChannels = 0;
+    return false;
+}
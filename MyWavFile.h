@@ -0,0 +1,87 @@
+#ifndef __MY_WAV_FILE__
+#define __MY_WAV_FILE__
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// Streaming RIFF/WAVE writer. Sizes in the header are patched on Close so
+/// the length doesn't have to be known up front.
+class MyWavWriter
+{
+public:
+    enum Format
+    {
+        PCM_16,
+        PCM_24,
+        FLOAT_32
+    };
+    
+    MyWavWriter();
+    ~MyWavWriter();
+    
+    bool Open(const std::string& path,
+              const double& sampleRate,
+              const int& numChannels,
+              const Format& format = PCM_16);
+    
+    /// Interleaved samples in [-1, 1], clipped for the integer formats.
+    bool Write(const float* data, const unsigned long& frameCount);
+    
+    bool Close();
+    
+    unsigned long GetFrameCount() const
+    {
+        return _frameCount;
+    }
+    
+private:
+    void WriteHeader();
+    
+    FILE* _file;
+    Format _format;
+    int _numChannels;
+    int _sampleRate;
+    unsigned long _frameCount;
+    
+    // Conversion buffer so the file is written in large chunks.
+    static const int BUFFER_BYTES = 1 << 16;
+    unsigned char _buffer[BUFFER_BYTES];
+};
+
+/// Reads a whole RIFF/WAVE file written by MyWavWriter (16, 24 bit or float)
+/// into interleaved floats.
+class MyWavReader
+{
+public:
+    MyWavReader();
+    
+    bool Read(const std::string& path);
+    
+    const float* GetData() const
+    {
+        return _data.data();
+    }
+    
+    unsigned long GetFrameCount() const
+    {
+        return _numChannels == 0 ? 0 : _data.size() / _numChannels;
+    }
+    
+    int GetNumChannels() const
+    {
+        return _numChannels;
+    }
+    
+    int GetSampleRate() const
+    {
+        return _sampleRate;
+    }
+    
+private:
+    std::vector<float> _data;
+    int _numChannels;
+    int _sampleRate;
+};
+
+#endif // __MY_WAV_FILE__
@@ -0,0 +1,127 @@
+#include "MyWorkerPool.h"
+#include <algorithm>
+#include <chrono>
+
+// Out of line definitions, std::min and the sleep durations take them by
+// reference.
+const int MyWorkerPool::MAX_JOBS;
+constexpr double MyWorkerPool::YIELD_TIME;
+constexpr double MyWorkerPool::POLL_SLEEP;
+constexpr double MyWorkerPool::PARK_TIME;
+constexpr double MyWorkerPool::PARK_SLEEP;
+
+/*******************************************************************************
+ * MyWorkerPool.
+ ******************************************************************************/
+MyWorkerPool::MyWorkerPool(const int& numThreads):
+_quit(false),
+_cursor(0),
+_job(nullptr),
+_done(0)
+{
+    for(int i = 0; i < numThreads; i++)
+    {
+        _threads.push_back(std::thread(&MyWorkerPool::WorkerLoop, this));
+    }
+}
+
+MyWorkerPool::~MyWorkerPool()
+{
+    _quit.store(true, std::memory_order_relaxed);
+    
+    for(auto& t : _threads)
+    {
+        t.join();
+    }
+}
+
+void MyWorkerPool::Dispatch(Job* job, const int& count)
+{
+    if(count <= 0)
+    {
+        return;
+    }
+    
+    const int shared = std::min(count, MAX_JOBS);
+    
+    _job.store(job, std::memory_order_relaxed);
+    _done.store(0, std::memory_order_relaxed);
+    
+    std::uint32_t generation = (std::uint32_t)
+        (_cursor.load(std::memory_order_relaxed) >> 32) + 1;
+    
+    _cursor.store((std::uint64_t)generation << 32 |
+                  (std::uint64_t)shared << 16, std::memory_order_release);
+    
+    RunJobs(generation);
+    
+    for(int i = shared; i < count; i++)
+    {
+        job->Run(i);
+    }
+    
+    while(_done.load(std::memory_order_acquire) < shared)
+    {
+        // Other threads are finishing their last job.
+    }
+}
+
+void MyWorkerPool::RunJobs(const std::uint32_t& generation)
+{
+    std::uint64_t cursor = _cursor.load(std::memory_order_acquire);
+    
+    while((std::uint32_t)(cursor >> 32) == generation)
+    {
+        const int count = (int)(cursor >> 16 & 0xFFFF);
+        const int index = (int)(cursor & 0xFFFF);
+        
+        if(index >= count)
+        {
+            return;
+        }
+        
+        if(_cursor.compare_exchange_weak(cursor, cursor + 1,
+                                         std::memory_order_acq_rel))
+        {
+            _job.load(std::memory_order_relaxed)->Run(index);
+            _done.fetch_add(1, std::memory_order_release);
+            cursor = _cursor.load(std::memory_order_acquire);
+        }
+    }
+}
+
+void MyWorkerPool::WorkerLoop()
+{
+    typedef std::chrono::steady_clock Clock;
+    typedef std::chrono::duration<double> Seconds;
+    
+    std::uint32_t seen = (std::uint32_t)
+        (_cursor.load(std::memory_order_acquire) >> 32);
+    Clock::time_point lastJob = Clock::now();
+    
+    while(!_quit.load(std::memory_order_relaxed))
+    {
+        const std::uint32_t generation = (std::uint32_t)
+            (_cursor.load(std::memory_order_acquire) >> 32);
+        
+        if(generation != seen)
+        {
+            seen = generation;
+            RunJobs(generation);
+            lastJob = Clock::now();
+            continue;
+        }
+        
+        const double idle = Seconds(Clock::now() - lastJob).count();
+        
+        if(idle < YIELD_TIME)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(Seconds(idle < PARK_TIME ?
+                                                POLL_SLEEP : PARK_SLEEP));
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef __MY_WORKER_POOL__
+#define __MY_WORKER_POOL__
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/// Fixed set of worker threads that run indexed jobs in parallel with the
+/// calling thread. Dispatch only publishes the jobs in an atomic, it never
+/// allocates, locks or makes a system call, so it can be called from the
+/// audio callback.
+///
+/// The price is on the worker side : with nothing to wake them up they poll
+/// for a new dispatch, yielding for a while after each one then sleeping
+/// longer and longer. A worker polling in its sleep picks up a dispatch late
+/// or not at all, the caller runs the jobs it doesn't take (see the pool
+/// bench of axTB303Bench).
+class MyWorkerPool
+{
+public:
+    class Job
+    {
+    public:
+        virtual ~Job()
+        {
+        }
+        
+        virtual void Run(const int& index) = 0;
+    };
+    
+    /// numThreads extra threads, the caller of Dispatch is always one more.
+    MyWorkerPool(const int& numThreads);
+    ~MyWorkerPool();
+    
+    int GetNumThreads() const
+    {
+        return (int)_threads.size();
+    }
+    
+    /// Calls job->Run(i) for every i in [0, count) and returns once they
+    /// are all done. The calling thread takes jobs too, so a worker that
+    /// wakes up late only costs parallelism, never correctness.
+    void Dispatch(Job* job, const int& count);
+    
+    /// Jobs shared with the workers per Dispatch, the calling thread runs
+    /// any past it alone.
+    static const int MAX_JOBS = 0xFFFF;
+    
+private:
+    void WorkerLoop();
+    void RunJobs(const std::uint32_t& generation);
+    
+    // Seconds since its last job a worker yields between polls, then sleeps
+    // POLL_SLEEP, then PARK_SLEEP once idle for PARK_TIME.
+    static constexpr double YIELD_TIME = 0.002;
+    static constexpr double POLL_SLEEP = 0.0001;
+    static constexpr double PARK_TIME = 0.1;
+    static constexpr double PARK_SLEEP = 0.002;
+    
+    std::vector<std::thread> _threads;
+    std::atomic<bool> _quit;
+    
+    // Generation in the high 32 bits, then the job count and the next job
+    // index in 16 bits each. Claiming a job is a CAS on all three, so a
+    // stale worker can neither take a job from a newer dispatch nor check
+    // its index against another dispatch's count.
+    std::atomic<std::uint64_t> _cursor;
+    std::atomic<Job*> _job;
+    std::atomic<int> _done;
+};
+
+#endif // __MY_WORKER_POOL__
@@ -1,4 +1,7 @@
 #include "main.h"
+#include "portaudio.h"
+#include <chrono>
+#include <cstdlib>
 #include <random>
 
 /*******************************************************************************
@@ -6,159 +9,62 @@
  ******************************************************************************/
 MyAudioSynth* MyAudioSynth::_instance = nullptr;
 
+
 MyAudioSynth* MyAudioSynth::GetInstance()
 {
     return _instance == nullptr ? _instance = new MyAudioSynth() : _instance;
 }
 
 MyAudioSynth::MyAudioSynth():
-axAudio()
+axAudio(),
+_bufferPlayer(nullptr)
 {
-    std::string app_path = axApp::GetInstance()->GetAppDirectory();
-    std::string snd_path = app_path + ("snare.wav");
-    
-    _notes = new Note[16];
-    
-    _sndBuffer = new axAudioBuffer(snd_path);
-    _bufferPlayer = new axAudioBufferPlayer(_sndBuffer);
-    _waveTable = new axAudioWaveTable();
-    _filter = new axAudioFilter();
-    _filter->SetFreq(20000.0);
-    _filter->SetQ(0.707);
-    _filter->SetGain(1.0);
-    
-    _waveTable->SetWaveformType(axAudioWaveTable::axWAVE_TYPE_SQUARE);
-    
-    _bpm = 120.0;
-    _mesureCount = 0;
-    _mesureTime = _bpm / (44100.0 * 60.0);
-    _timeCount = 0.0;
-    
-    axRange<double> range(44100.0 / 16, 44100.0 / 2);
-    _decayTime = range.GetValueFromZeroToOne(0.5);
-    _decayIndex = 0.0;
-    
-    _volume = 0.0;
-    
-    struct Note
-    {
-        bool slide, up, down, on;
-        int note;
-    };
-    
-    for(int i = 0; i < 16; i++)
-    {
-        _notes[i].on = true;
-        _notes[i].slide = false;
-        _notes[i].up = false;
-        _notes[i].down = false;
-        _notes[i].note = 0;
-        _notes[i].accent = false;
-    }
-}
 
-void MyAudioSynth::SetVolume(const double& volume)
-{
-    _volume = axClamp<double>(volume, 0.0, 1.0);
 }
 
-void MyAudioSynth::Play()
+void MyAudioSynth::InitAudio()
 {
-    _bufferPlayer->Play();
+    axAudio::InitAudio();
+    
+    // axAudio opens the default output device at its default rate.
+    const PaDeviceInfo* info = Pa_GetDeviceInfo(Pa_GetDefaultOutputDevice());
+    
+    if(info != nullptr && info->defaultSampleRate > 0.0)
+    {
+        SetSampleRate(info->defaultSampleRate);
+    }
 }
 
-void MyAudioSynth::SetWaveformType(const axAudioWaveTable::axWaveformType& type)
+void MyAudioSynth::StartAudio()
 {
-    _waveTable->SetWaveformType(type);
+    SetRunning(true);
+    axAudio::StartAudio();
 }
 
-void MyAudioSynth::SetFilterFreq(const double& freq)
+void MyAudioSynth::StopAudio()
 {
-    _filter->SetFreq(freq);
+    axAudio::StopAudio();
+    SetRunning(false);
 }
 
-void MyAudioSynth::SetFilterRes(const double& res)
+void MyAudioSynth::Play()
 {
-    _filter->SetQ(res);
+    // The snare is only decoded the first time it's played.
+    if(_bufferPlayer == nullptr)
+    {
+        MyResources* res = MyResources::GetInstance();
+        _bufferPlayer = new axAudioBufferPlayer(
+            res->GetSound(res->GetAppPath("snare.wav")));
+    }
+    
+    _bufferPlayer->Play();
 }
 
 int MyAudioSynth::CallbackAudio(const float* input,
                                     float* output,
                                     unsigned long frameCount)
 {
-    _timeCount += (frameCount);
-    
-    if(_timeCount >= 44100.0 / 4.0)//_mesureTime)
-    {
-        _timeCount = 0.0;
-        
-        double r = _notes[_mesureCount].up ? 2.0 : 1.0;
-        double r2 =  _notes[_mesureCount].down ? 0.5 : 1.0;
-        _waveTable->SetFreq(r * r2 * _tuning * 110.0 *
-                            pow(2.0, _notes[_mesureCount].note / 12.0));
-        
-        if(_notes[_mesureCount].on)
-        {
-            
-            _decayIndex = 0.0;
-        }
-        
-        ++_mesureCount;
-        
-        if(_mesureCount >= 16)
-        {
-            _mesureCount = 0;
-        }
-        
-    }
-    
-    if(_waveTable != nullptr)
-    {
-        double v = 0.0;
-        
-        _waveTable->ProcessBlock(output, frameCount);
-        _filter->ProcessStereoBlock(output, frameCount);
-        
-        for(int i = 0; i < frameCount; i++)
-        {
-            _decayIndex++;
-            
-            double decaySample = _decayTime;
-            
-            if(_decayIndex >= decaySample)
-            {
-                v = 0.0;
-            }
-            else
-            {
-                // Fade in.
-                if(_decayIndex <= 30)
-                {
-                    // Attack.
-                    v = axClamp<double>(_decayIndex / 20.0, 0.0, 1.0);
-                }
-                else
-                {
-                    // Decay.
-                    v = 1.0 - ((_decayIndex) / decaySample);
-                    v = axClamp<double>(v, 0.0, 1.0);
-                }
-                
-            }
-            
-            *output++ = *output * v * _volume;
-            *output++ = *output * v * _volume;
-        }
-    }
-    else
-    {
-        for(int i = 0; i < frameCount; i++)
-        {
-            *output++ = 0.0f;
-            *output++ = 0.0f;
-        }
-    }
-
+    Process(output, frameCount);
     return 0;
 }
 
@@ -169,37 +75,31 @@ MyLED::MyLED(axWindow* parent,
              const axRect& rect) :
 axPanel(parent, rect)
 {
-    _ledImg = new axImage("axLED_9x9.png");
     _imgIndex = 0;
 }
 
 void MyLED::SetActive(const bool& on)
 {
-    if(on)
-    {
-        _imgIndex = 1;
-    }
-    else
+    const int index = on ? 1 : 0;
+    
+    // Only repaint on a change, the sequencer sets every step LED each step.
+    if(index != _imgIndex)
     {
-        _imgIndex = 0;
+        _imgIndex = index;
+        Update();
     }
-    
-    Update();
 }
 
 void MyLED::SetOff()
 {
-    _imgIndex = 0;
-    Update();
+    SetActive(false);
 }
 
 void MyLED::OnPaint()
 {
     axGC* gc = GetGC();
-    axRect rect = axRect(axPoint(0, 0), GetRect().size);
     
-
-    gc->DrawPartOfImage(_ledImg,
+    gc->DrawPartOfImage(MyResources::GetInstance()->GetImage("axLED_9x9.png"),
                         axPoint(0, _imgIndex * 9),
                         axSize(9, 9),
                         axPoint(0, 0));
@@ -211,14 +111,24 @@ void MyLED::OnPaint()
 MyNumberPanel::MyNumberPanel(axWindow* parent,
                              const axPoint& pos) :
 axPanel(parent, axRect(pos, axSize(28, 15))),
-_number(1)
+_number(-1),
+_fontReady(false)
 {
-
+    SetNumber(1);
 }
 
 void MyNumberPanel::SetNumber(const int& num)
 {
-    _number = axClamp<int>(num, 0, 99);
+    const int number = axClamp<int>(num, 0, 99);
+    
+    if(number == _number)
+    {
+        return;
+    }
+    
+    _number = number;
+    _digits[0] = _number > 9 ? '0' + _number / 10 : ' ';
+    _digits[1] = '0' + _number % 10;
     Update();
 }
 
@@ -236,25 +146,28 @@ void MyNumberPanel::OnPaint()
     gc->DrawRectangle(rect);
     
     gc->SetColor(axColor(0.4, 0.0, 0.0, 1.0));
-    gc->SetFontType(std::string("digital-7 (mono).ttf"));
-    gc->SetFontSize(16);
+    
+    // Loading the face is the expensive part of the paint, do it once.
+    if(!_fontReady)
+    {
+        gc->SetFontType(std::string("digital-7 (mono).ttf"));
+        gc->SetFontSize(16);
+        _fontReady = true;
+    }
+    
     gc->DrawChar('0', axPoint(5, -4));
     gc->DrawChar('0', axPoint(13, -4));
     
     
     gc->SetColor(axColor(0.95, 0.0, 0.0, 1.0));
     
-    if(_number > 9)
+    if(_digits[0] != ' ')
     {
-        gc->DrawChar(std::to_string(_number)[0], axPoint(5, -4));
-
-        gc->DrawChar(std::to_string(_number)[1], axPoint(13, -4));
-    }
-    else
-    {
-        gc->DrawChar(std::to_string(_number)[0], axPoint(13, -4));
+        gc->DrawChar(_digits[0], axPoint(5, -4));
     }
     
+    gc->DrawChar(_digits[1], axPoint(13, -4));
+    
     gc->SetColor(axColor(0.4, 0.0, 0.0, 1.0));
     gc->DrawRectangleContour(rect.GetInteriorRect(axPoint(1, 1)));
     
@@ -357,7 +270,29 @@ MyButton* MyButton::MyButtonBuilder::Create(const axEventFunction& evt)
 MyPreference::MyPreference(const axRect& rect) :
 axPanel(3, nullptr, rect)
 {
+    // Well within the profiler ring at any buffer size.
+    _loadTimer = new axTimer();
+    _loadTimer->AddConnection(0, GetOnLoadTimer());
+    _loadTimer->StartTimer(250);
+}
 
+void MyPreference::OnLoadTimer(const axTimerMsg& msg)
+{
+    // Load since the last tick.
+    MyProfiler& profiler = MyAudioSynth::GetInstance()->GetProfiler();
+    profiler.Poll();
+    
+    char load[64];
+    snprintf(load, sizeof(load), "DSP %d%%  max %d%%  xruns %lu",
+             (int)(profiler.GetLastBlock().load * 100.0f),
+             (int)(profiler.GetWorstLoad() * 100.0f),
+             profiler.GetXrunCount());
+    
+    if(_load != load)
+    {
+        _load = load;
+        Update();
+    }
 }
 
 void MyPreference::OnPaint()
@@ -371,6 +306,7 @@ void MyPreference::OnPaint()
     
     gc->SetColor(axColor(0.0, 0.0, 0.0));
     gc->DrawString(std::string("Audio"), axPoint(20, 20));
+    gc->DrawString(_load, axPoint(20, 36));
     
     gc->SetColor(axColor(0.0, 0.0, 0.0));
     gc->DrawRectangleContour(rect);
@@ -382,9 +318,7 @@ void MyPreference::OnPaint()
 MyProject::MyProject(axWindow* parent, const axRect& rect):
 axPanel(parent, rect)
 {
-    std::string app_path = axApp::GetInstance()->GetAppDirectory();
-    
-    _bgImg = new axImage(app_path + std::string("tb303.png"));
+    MyResources* resources = MyResources::GetInstance();
     
     axButtonInfo btn_info(axColor(0.4, 0.4, 0.4, 1.0),
                           axColor(0.5, 0.5, 0.5, 1.0),
@@ -417,8 +351,8 @@ axPanel(parent, rect)
     
     _btns[DOWN] = btnBuilder.Create(GetOnDownClick());
     _btns[UP] = btnBuilder.Create(GetOnUpClick());
-    _btns[ACCENT] = btnBuilder.Create(GetOnButtonClick());
-    _btns[SLIDE] = btnBuilder.Create(GetOnButtonClick());
+    _btns[ACCENT] = btnBuilder.Create(GetOnAccentClick());
+    _btns[SLIDE] = btnBuilder.Create(GetOnSlideClick());
     
     // Dark buttons.
     btnBuilder.SetInfo(btn_info_dark);
@@ -436,15 +370,17 @@ axPanel(parent, rect)
                                   axEventFunction(),
                                   btn_info);
     
+    // Records knob moves into the playing steps while lit.
     MyButton* pitch = new MyButton(this,
                                    axRect(axPoint(132, 120), horiBtnSize),
-                                   axEventFunction(),
+                                   axEventFunction(GetOnRecordClick()),
                                    btn_info_dark,
                                    axPoint(15, -17));
     
+    // Clears the knob moves of the pattern being edited.
     axButton* clear = new axButton(this,
                                    axRect(axPoint(50, 120), horiBtnSize),
-                                   axEventFunction(),
+                                   axButtonEvents(GetOnClearClick()),
                                    btn_info);
     
     MyButton* run = new MyButton(this,
@@ -473,18 +409,18 @@ axPanel(parent, rect)
                          axColor(0.3, 0.3, 0.3, 0.0),
                          128,
                          axSize(46, 46),
-                         app_path + std::string("knob_dark.png"),
-                         app_path + std::string("knob_dark.png"));
+                         resources->GetAppPath("knob_dark.png"),
+                         resources->GetAppPath("knob_dark.png"));
     
     
     knob_info.knob_size = axSize(50, 50);
-    knob_info.img_path = app_path + std::string("axKnobTB303_50x50.png");
-    knob_info.selected_img_path = app_path + std::string("axKnobTB303_50x50.png");
+    knob_info.img_path = resources->GetAppPath("axKnobTB303_50x50.png");
+    knob_info.selected_img_path = resources->GetAppPath("axKnobTB303_50x50.png");
     
     axSize knob_size(50, 50);
     
     axKnob* speed = new axKnob(this, axRect(axPoint(15, 25), knob_size),
-                               axKnobEvents(),
+                               axKnobEvents(GetOnSpeedChange()),
                                knob_info);
     speed->SetValue(0.5);
     
@@ -510,7 +446,7 @@ axPanel(parent, rect)
     res->SetValue(0.0);
     
     axKnob* f4 = new axKnob(this, axRect(res->GetNextPosRight(10), knob_size),
-                           axKnobEvents(),
+                           axKnobEvents(GetOnEnvModChange()),
                            knob_info);
     f4->SetValue(0.5);
     
@@ -520,11 +456,25 @@ axPanel(parent, rect)
     f5->SetValue(0.5);
     
     axKnob* f6 = new axKnob(this, axRect(f5->GetNextPosRight(10), knob_size),
-                            axKnobEvents(),
+                            axKnobEvents(GetOnAccentChange()),
                             knob_info);
     f6->SetValue(0.5);
     
     _numberPanel = new MyNumberPanel(this, axPoint(778, 165));
+    
+    // Step playing, left of the step being edited, with its gate and
+    // accent.
+    _playPanel = new MyNumberPanel(this, axPoint(744, 165));
+    _playPanel->SetNumber(0);
+    _gateLed = new MyLED(this, axRect(axPoint(732, 163), axSize(9, 9)));
+    _accentLed = new MyLED(this, axRect(axPoint(732, 174), axSize(9, 9)));
+    
+    // Position in the bar along the bottom, under the note buttons.
+    for(int i = 0; i < MyPatternBank::STEPS_PER_BAR; i++)
+    {
+        _stepLeds.push_back(new MyLED(this, axRect(axPoint(210 + i * 28, 256),
+                                                   axSize(9, 9))));
+    }
 
     
     axButton* prefBtn = new axButton(this,
@@ -539,6 +489,16 @@ axPanel(parent, rect)
     
     _pref = new MyPreference(axRect(640, 10, 170, 58));
     _pref->Hide();
+    
+    _stepTimer = new axTimer();
+    _stepTimer->AddConnection(0, GetOnStepTimer());
+}
+
+void MyProject::OnSpeedChange(const axKnobMsg& msg)
+{
+    // Centered on the 120 bpm the synth starts at.
+    axRange<double> range(60.0, 180.0);
+    MyAudioSynth::GetInstance()->SetBpm(range.GetValueFromZeroToOne(msg.GetValue()));
 }
 
 void MyProject::OnVolumeChange(const axKnobMsg& msg)
@@ -558,23 +518,23 @@ void MyProject::OnWaveChoice(const axDropMenuMsg& msg)
     std::string m = msg.GetMsg();
     if(m == "Sine")
     {
-        audio->SetWaveformType(axAudioWaveTable::
-                               axWaveformType::axWAVE_TYPE_SINE);
+        audio->SetWaveformType(MyOscillator::SINE);
     }
     else if(m == "Triangle")
     {
-        audio->SetWaveformType(axAudioWaveTable::
-                               axWaveformType::axWAVE_TYPE_TRIANGLE);
+        audio->SetWaveformType(MyOscillator::TRIANGLE);
     }
     else if(m == "Square")
     {
-        audio->SetWaveformType(axAudioWaveTable::
-                               axWaveformType::axWAVE_TYPE_SQUARE);
+        audio->SetWaveformType(MyOscillator::SQUARE);
     }
     else if(m == "Saw")
     {
-        audio->SetWaveformType(axAudioWaveTable::
-                               axWaveformType::axWAVE_TYPE_SAW);
+        audio->SetWaveformType(MyOscillator::SAW);
+    }
+    else if(m == "Pulse")
+    {
+        audio->SetWaveformType(MyOscillator::PULSE);
     }
 }
 
@@ -596,6 +556,22 @@ void MyProject::OnDownClick(const axButtonMsg& msg)
                                                sender->IsActive());
 }
 
+void MyProject::OnAccentClick(const axButtonMsg& msg)
+{
+    MyButton* sender = static_cast<MyButton*>(msg.GetSender());
+    
+    MyAudioSynth::GetInstance()->SetNoteInfoAccent(_numberPanel->GetNumber() - 1,
+                                                   sender->IsActive());
+}
+
+void MyProject::OnSlideClick(const axButtonMsg& msg)
+{
+    MyButton* sender = static_cast<MyButton*>(msg.GetSender());
+    
+    MyAudioSynth::GetInstance()->SetNoteInfoSlide(_numberPanel->GetNumber() - 1,
+                                                  sender->IsActive());
+}
+
 void MyProject::OnNoteClick(const axButtonMsg& msg)
 {
 //    std::cout << "Note click : " << msg.GetSender()->GetId() << std::endl;
@@ -639,8 +615,6 @@ void MyProject::OnNoteClick(const axButtonMsg& msg)
         case NOTE_C1: index = 12; break;
     }
     
-    
-    std::cout << "NOTE CLICK : " << _numberPanel->GetNumber() - 1 << " " << index << std::endl;
     MyAudioSynth::GetInstance()->SetNoteInfoNote(_numberPanel->GetNumber() - 1,
                                                  index);
 }
@@ -650,16 +624,28 @@ void MyProject::OnRunClick(const axButtonMsg& msg)
     if(static_cast<MyButton*>(msg.GetSender())->IsActive())
     {
         MyAudioSynth::GetInstance()->StartAudio();
+        
+        // About once per screen refresh.
+        _stepTimer->StartTimer(16);
     }
     else
     {
         MyAudioSynth::GetInstance()->StopAudio();
+        _stepTimer->StopTimer();
+        _playPanel->SetNumber(0);
+        ShowPlayingStep(-1, MyAudioSynth::Note());
     }
 }
 
-void MyProject::OnButtonClick(const axButtonMsg& msg)
+void MyProject::OnRecordClick(const axButtonMsg& msg)
 {
-    std::cout << "Button click." << std::endl;
+    MyButton* sender = static_cast<MyButton*>(msg.GetSender());
+    MyAudioSynth::GetInstance()->SetAutomationRecord(sender->IsActive());
+}
+
+void MyProject::OnClearClick(const axButtonMsg& msg)
+{
+    MyAudioSynth::GetInstance()->ClearAutomation();
 }
 
 void MyProject::OnDecayChange(const axKnobMsg& msg)
@@ -677,55 +663,88 @@ void MyProject::OnFreqChange(const axKnobMsg& msg)
 
 void MyProject::OnResChange(const axKnobMsg& msg)
 {
-    axRange<double> qRange(0.707, 10.0);
-    double r = qRange.GetValueFromZeroToOne(msg.GetValue());
-    
-    MyAudioSynth::GetInstance()->SetFilterRes(r);
+    MyAudioSynth::GetInstance()->SetFilterRes(msg.GetValue());
+}
+
+void MyProject::OnEnvModChange(const axKnobMsg& msg)
+{
+    MyAudioSynth::GetInstance()->SetEnvMod(msg.GetValue());
+}
+
+void MyProject::OnAccentChange(const axKnobMsg& msg)
+{
+    MyAudioSynth::GetInstance()->SetAccent(msg.GetValue());
 }
 
 void MyProject::UpdateParameters(const int& index)
 {
-    std::vector<MyButtonId> ids = { NOTE_C0, NOTE_D, NOTE_E, NOTE_F, NOTE_G,
-        NOTE_A, NOTE_B, NOTE_C1, NOTE_C0_S,
-        NOTE_D_S, NOTE_F_S, NOTE_G_S, NOTE_A_S };
+    const MyAudioSynth::Note* notes = MyAudioSynth::GetInstance()->GetNotes();
+    ShowNote(notes[index]);
+}
+
+void MyProject::ShowNote(const MyAudioSynth::Note& note)
+{
+    // Button of each semitone from C0 to C1.
+    static const MyButtonId ids[] = { NOTE_C0, NOTE_C0_S, NOTE_D, NOTE_D_S,
+        NOTE_E, NOTE_F, NOTE_F_S, NOTE_G, NOTE_G_S, NOTE_A, NOTE_A_S,
+        NOTE_B, NOTE_C1 };
     
-    for(auto& n : ids)
+    // Each LED repaints itself if it changed, the background stays as is.
+    for(int i = 0; i < 13; i++)
     {
-        _btns[n]->SetActive(false);
+        _btns[ids[i]]->SetActive(note.note == i);
     }
     
-    const MyAudioSynth::Note* notes = MyAudioSynth::GetInstance()->GetNotes();
+    _btns[DOWN]->SetActive(note.down);
+    _btns[UP]->SetActive(note.up);
+    _btns[ACCENT]->SetActive(note.accent);
+    _btns[SLIDE]->SetActive(note.slide);
+}
+
+void MyProject::OnStepTimer(const axTimerMsg& msg)
+{
+    MyAudioSynth::StepEvent event;
+    bool played = false;
     
-    switch(notes[index].note)
+    // Only the latest step is drawn, the ones in between went by faster
+    // than a frame.
+    while(MyAudioSynth::GetInstance()->PopStepEvent(event))
     {
-        case 0: _btns[NOTE_C0]->SetActive(true); break;
-        case 1: _btns[NOTE_C0_S]->SetActive(true); break;
-        case 2: _btns[NOTE_D]->SetActive(true); break;
-        case 3: _btns[NOTE_D_S]->SetActive(true); break;
-        case 4: _btns[NOTE_E]->SetActive(true); break;
-        case 5: _btns[NOTE_F]->SetActive(true); break;
-        case 6: _btns[NOTE_F_S]->SetActive(true); break;
-        case 7: _btns[NOTE_G]->SetActive(true); break;
-        case 8: _btns[NOTE_G_S]->SetActive(true); break;
-        case 9: _btns[NOTE_A]->SetActive(true); break;
-        case 10: _btns[NOTE_A_S]->SetActive(true); break;
-        case 11: _btns[NOTE_B]->SetActive(true); break;
-        case 12: _btns[NOTE_C1]->SetActive(true); break;
+        played = true;
     }
     
-    _btns[DOWN]->SetActive(notes[index].down);
-    _btns[UP]->SetActive(notes[index].up);
-    _btns[ACCENT]->SetActive(notes[index].accent);
-    _btns[SLIDE]->SetActive(notes[index].slide);
+    // The edit step and its LEDs stay put, a click during playback still
+    // edits the step shown in _numberPanel.
+    if(played)
+    {
+        // The number is 0 while another pattern than the edited one plays.
+        MyAudioSynth* audio = MyAudioSynth::GetInstance();
+        _playPanel->SetNumber(event.pattern == audio->GetPattern() ?
+                              event.step + 1 : 0);
+        ShowPlayingStep(event.step, event.note);
+    }
+}
+
+void MyProject::ShowPlayingStep(const int& step,
+                                const MyAudioSynth::Note& note)
+{
+    const int bar = MyPatternBank::STEPS_PER_BAR;
     
-    Update();
+    // Each LED repaints itself only if it changed.
+    for(int i = 0; i < bar; i++)
+    {
+        _stepLeds[i]->SetActive(step >= 0 && step % bar == i);
+    }
+    
+    _gateLed->SetActive(step >= 0 && note.on);
+    _accentLed->SetActive(step >= 0 && note.on && note.accent);
 }
 
 void MyProject::OnNextEditPattern(const axButtonMsg& msg)
 {
     int num = _numberPanel->GetNumber();
     ++num;
-    if(num > 16)
+    if(num > MyAudioSynth::GetInstance()->GetPatternLength())
     {
         num = 1;
     }
@@ -741,7 +760,7 @@ void MyProject::OnBackEditPattern(const axButtonMsg& msg)
     --num;
     if(num < 1)
     {
-        num = 16;
+        num = MyAudioSynth::GetInstance()->GetPatternLength();
     }
     
     _numberPanel->SetNumber(num);
@@ -766,10 +785,19 @@ void MyProject::OnPaint()
     axGC* gc = GetGC();
     axRect rect0(axPoint(0, 0), GetRect().size);
     
-    gc->SetColor(axColor(0.4, 0.4, 0.4), 1.0);
-    gc->DrawRectangle(rect0);
+    MyResources* res = MyResources::GetInstance();
+    axImage* bg = res->GetImage(res->GetAppPath("tb303.png"));
     
-    gc->DrawImage(_bgImg, axPoint(0, 0));
+    // The image covers the whole panel, the fill is only a fallback.
+    if(bg->IsImageReady())
+    {
+        gc->DrawImage(bg, axPoint(0, 0));
+    }
+    else
+    {
+        gc->SetColor(axColor(0.4, 0.4, 0.4), 1.0);
+        gc->DrawRectangle(rect0);
+    }
 
     gc->SetColor(axColor(0.0, 0.0, 0.0), 1.0);
     gc->DrawRectangleContour(rect0);
@@ -778,12 +806,41 @@ void MyProject::OnPaint()
 
 void axMain::MainEntryPoint(axApp* app)
 {
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    
     MyAudioSynth* audio = MyAudioSynth::GetInstance();
 
     MyProject* myProject = new MyProject(nullptr, axRect(0, 0, 856, 273));
     
     audio->InitAudio();
 //    audio->StartAudio();
+    
+    // MIDI port to play from and follow the clock of, see MyMidiInput.
+    if(const char* midi = getenv("AXTB303_MIDI"))
+    {
+        if(audio->OpenMidiInput(midi))
+        {
+            audio->SetMidiSync(true);
+        }
+        else
+        {
+            std::cerr << "Could not open MIDI input " << midi << std::endl;
+        }
+    }
+    
+    // Images are decoded on the first paint, after this, so anything
+    // decoded so far is startup time the cache didn't save.
+    if(getenv("AXTB303_STARTUP_TIME"))
+    {
+        MyResources* resources = MyResources::GetInstance();
+        std::cout << "Startup : "
+                  << std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - start).count()
+                  << " ms, " << resources->GetLoadCount()
+                  << " files decoded in "
+                  << resources->GetLoadTime() * 1000.0 << " ms" << std::endl;
+    }
 }
 
 
@@ -6,96 +6,34 @@
 #include "axAudioFilter.h"
 #include "axAudioBuffer.h"
 #include "axAudioBufferPlayer.h"
-#include "axAudioWaveTable.h"
 
-class MyAudioSynth: public axAudio
+#include "MyResources.h"
+#include "MySynth.h"
+
+/// Plays a MySynth on the default axAudio output device.
+class MyAudioSynth: public axAudio, public MySynth
 {
 public:
     static MyAudioSynth* GetInstance();
-
-    void SetWaveformType(const axAudioWaveTable::axWaveformType& type);
-    
-    void SetFilterFreq(const double& freq);
-    void SetFilterRes(const double& res);
     
+    using MySynth::SetSampleRate;
     
     void Play();
     
-    void SetVolume(const double& volume);
-    
-    void SetDecay(const double& decay)
-    {
-        axRange<double> range(44100.0 / 16, 44100.0 / 2);
-        _decayTime = range.GetValueFromZeroToOne(decay);
-    }
-    
-    struct Note
-    {
-        bool slide, up, down, on, accent;
-        int note;
-    };
-    
-    const Note* GetNotes() const
-    {
-        return _notes;
-    }
-    
-    void SetNoteInfo(const int& index, const Note& note)
-    {
-        _notes[index] = note;
-    }
-    
-    void SetNoteInfoNote(const int& index, const int& note)
-    {
-        _notes[index].note = note;
-    }
-    
-    void SetNoteInfoOn(const int& index, const bool& on)
-    {
-        _notes[index].on = on;
-    }
-    
-    void SetNoteInfoUp(const int& index, const bool& up)
-    {
-        _notes[index].up = up;
-    }
-    
-    void SetNoteInfoDown(const int& index, const bool& down)
-    {
-        _notes[index].down = down;
-    }
-    
-    void SetTuning(const double& tune)
-    {
-        _tuning = axClamp<double>(tune, 0.5, 2.0);
-    }
+    /// Opens the stream and picks up the device sample rate.
+    void InitAudio();
+    void StartAudio();
+    void StopAudio();
     
 private:
     MyAudioSynth();
     static MyAudioSynth* _instance;
-
-    axAudioBuffer* _sndBuffer;
+    
     axAudioBufferPlayer* _bufferPlayer;
-    axAudioFilter* _filter;
-    axAudioWaveTable* _waveTable;
-
+    
     virtual int CallbackAudio(const float* input,
                               float* output,
                               unsigned long frameCount);
-    
-    double _bpm;
-    int _mesureCount;
-    double _mesureTime;
-    double _timeCount;
-    
-    double _decayTime;
-    double _decayIndex;
-    
-    double _volume;
-    double _tuning = {1.0};
-    Note* _notes;
-    
-    bool _running = {false};
 };
 
 
@@ -116,9 +54,6 @@ public:
 private:
     void OnPaint();
     int _imgIndex;
-    
-    
-    axImage* _ledImg;
 };
 
 class MyNumberPanel : public axPanel
@@ -133,6 +68,8 @@ public:
 private:
     void OnPaint();
     int _number;
+    char _digits[2]; // ' ' when the tens are blank.
+    bool _fontReady; // The font lives in our own GC.
 };
 
 class MyButton : public axButton
@@ -202,9 +139,15 @@ class MyPreference : public axPanel
 public:
     MyPreference(const axRect& rect);
     
+    axEVENT_ACCESSOR(axTimerMsg, OnLoadTimer);
+    
 private:
+    axTimer* _loadTimer; // Drains the profiler, shown or not.
+    std::string _load; // DSP load line as drawn.
+    
     // Events.
     virtual void OnPaint();
+    void OnLoadTimer(const axTimerMsg& msg);
 };
 
 class MyProject: public axPanel
@@ -214,17 +157,23 @@ public:
               const axRect& rect);
 
     axEVENT_ACCESSOR(axButtonMsg, OnRunClick);
+    axEVENT_ACCESSOR(axButtonMsg, OnRecordClick);
+    axEVENT_ACCESSOR(axButtonMsg, OnClearClick);
     axEVENT_ACCESSOR(axButtonMsg, OnNoteClick);
-    axEVENT_ACCESSOR(axButtonMsg, OnButtonClick);
     axEVENT_ACCESSOR(axDropMenuMsg, OnWaveChoice);
     
     axEVENT_ACCESSOR(axButtonMsg, OnDownClick);
     axEVENT_ACCESSOR(axButtonMsg, OnUpClick);
+    axEVENT_ACCESSOR(axButtonMsg, OnAccentClick);
+    axEVENT_ACCESSOR(axButtonMsg, OnSlideClick);
     
+    axEVENT_ACCESSOR(axKnobMsg, OnSpeedChange);
     axEVENT_ACCESSOR(axKnobMsg, OnTuningChange);
     axEVENT_ACCESSOR(axKnobMsg, OnVolumeChange);
     axEVENT_ACCESSOR(axKnobMsg, OnFreqChange);
     axEVENT_ACCESSOR(axKnobMsg, OnResChange);
+    axEVENT_ACCESSOR(axKnobMsg, OnEnvModChange);
+    axEVENT_ACCESSOR(axKnobMsg, OnAccentChange);
     
     axEVENT_ACCESSOR(axKnobMsg, OnDecayChange);
     
@@ -233,6 +182,8 @@ public:
     
     axEVENT_ACCESSOR(axButtonMsg, OnPreference);
     
+    axEVENT_ACCESSOR(axTimerMsg, OnStepTimer);
+    
     enum MyButtonId
     {
         NOTE_C0,
@@ -261,32 +212,51 @@ private:
     
     void UpdateParameters(const int& index);
     
+    /// Lights the LEDs of a step.
+    void ShowNote(const MyAudioSynth::Note& note);
+    
+    /// Lights the playback LEDs from a step event, the edit ones are left
+    /// alone. A negative step turns them all off.
+    void ShowPlayingStep(const int& step, const MyAudioSynth::Note& note);
+    
     // Events.
     virtual void OnPaint();
     
     void OnRunClick(const axButtonMsg& msg);
+    void OnRecordClick(const axButtonMsg& msg);
+    void OnClearClick(const axButtonMsg& msg);
     void OnNoteClick(const axButtonMsg& msg);
-    void OnButtonClick(const axButtonMsg& msg);
     void OnWaveChoice(const axDropMenuMsg& msg);
     
     void OnDownClick(const axButtonMsg& msg);
     void OnUpClick(const axButtonMsg& msg);
+    void OnAccentClick(const axButtonMsg& msg);
+    void OnSlideClick(const axButtonMsg& msg);
     
+    void OnSpeedChange(const axKnobMsg& msg);
     void OnVolumeChange(const axKnobMsg& msg);
     void OnTuningChange(const axKnobMsg& msg);
     void OnFreqChange(const axKnobMsg& msg);
     void OnResChange(const axKnobMsg& msg);
+    void OnEnvModChange(const axKnobMsg& msg);
+    void OnAccentChange(const axKnobMsg& msg);
     
     void OnDecayChange(const axKnobMsg& msg);
     
     void OnPreference(const axButtonMsg& msg);
+    void OnStepTimer(const axTimerMsg& msg);
     
     
     void OnNextEditPattern(const axButtonMsg& msg);
     void OnBackEditPattern(const axButtonMsg& msg);
     
     axImage* _bgImg;
-    MyNumberPanel* _numberPanel;
+    MyNumberPanel* _numberPanel; // Step being edited.
+    MyNumberPanel* _playPanel; // Step playing.
+    std::vector<MyLED*> _stepLeds; // Step playing in its bar.
+    MyLED* _gateLed; // Gate of the step playing.
+    MyLED* _accentLed; // Accent of the step playing.
+    axTimer* _stepTimer; // Follows the playing step while running.
     MyPreference* _pref;
     std::vector<MyButton*> _btns;
 };
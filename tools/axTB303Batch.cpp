@@ -0,0 +1,205 @@
+// Batch renderer for pattern libraries.
+//
+// axTB303Batch -i patterns/ [-o out/] [options]
+//   Loads every .pat file of the input directory (see MyPatternText) and
+//   reports the load throughput. With -o, each pattern is also rendered to
+//   out/<file>_<line>.wav.
+//   --bars 1 --rate 44100 --format 16|24|float
+//   --preset lib.303p --index 0       Knob settings, see MyPresetFile.
+
+#include "../MyOfflineRenderer.h"
+#include "../MyPatternText.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <dirent.h>
+#include <iostream>
+#include <vector>
+
+struct Entry
+{
+    std::string name;
+    int line;
+    MyPatternBank::Pattern pattern;
+};
+
+static bool EndsWith(const std::string& str, const std::string& suffix)
+{
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string input, output, presetPath, format = "16";
+    double rate = 44100.0, bars = 1.0;
+    int presetIndex = 0;
+    
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        const char* value = argv[i + 1];
+        
+        if(arg == "-i") input = value;
+        else if(arg == "-o") output = value;
+        else if(arg == "--preset") presetPath = value;
+        else if(arg == "--index") presetIndex = atoi(value);
+        else if(arg == "--format") format = value;
+        else if(arg == "--rate") rate = atof(value);
+        else if(arg == "--bars") bars = atof(value);
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+    
+    if(input.empty())
+    {
+        std::cerr << "Usage : axTB303Batch -i dir [-o dir] [options]"
+                  << std::endl;
+        return 1;
+    }
+    
+    MyPreset preset;
+    preset.volume = 0.8;
+    
+    if(!presetPath.empty())
+    {
+        MyPresetFile file;
+        
+        if(!file.Open(presetPath) || !file.Read(presetIndex, preset))
+        {
+            std::cerr << "Could not read preset " << presetIndex << " from "
+                      << presetPath << std::endl;
+            return 1;
+        }
+    }
+    
+    // Load everything first so the throughput only measures the parser and
+    // the disk.
+    std::vector<std::string> files;
+    DIR* dir = opendir(input.c_str());
+    
+    if(dir == nullptr)
+    {
+        std::cerr << "Could not open " << input << std::endl;
+        return 1;
+    }
+    
+    while(dirent* ent = readdir(dir))
+    {
+        if(EndsWith(ent->d_name, ".pat"))
+        {
+            files.push_back(ent->d_name);
+        }
+    }
+    
+    closedir(dir);
+    std::sort(files.begin(), files.end());
+    
+    std::vector<Entry> entries;
+    entries.reserve(files.size() * 4);
+    
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    
+    MyPatternText reader;
+    unsigned long bytes = 0;
+    int errors = 0;
+    
+    for(const std::string& name : files)
+    {
+        if(!reader.Open(input + "/" + name))
+        {
+            std::cerr << "Could not open " << name << std::endl;
+            ++errors;
+            continue;
+        }
+        
+        Entry entry;
+        entry.name = name.substr(0, name.size() - 4);
+        
+        while(reader.Read(entry.pattern))
+        {
+            entry.line = reader.GetLine();
+            entries.push_back(entry);
+        }
+        
+        if(reader.HasError())
+        {
+            std::cerr << name << ":" << reader.GetLine()
+                      << " : invalid pattern" << std::endl;
+            ++errors;
+        }
+        
+        bytes += reader.GetBytesRead();
+        reader.Close();
+    }
+    
+    double loadTime = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Loaded " << entries.size() << " patterns from "
+              << files.size() << " files (" << bytes << " bytes) in "
+              << loadTime * 1000.0 << " ms : "
+              << entries.size() / std::max(loadTime, 1e-9) << " patterns/s, "
+              << bytes / std::max(loadTime, 1e-9) / 1e6 << " MB/s"
+              << std::endl;
+    
+    if(output.empty())
+    {
+        return errors == 0 ? 0 : 1;
+    }
+    
+    MyWavWriter::Format fmt = MyWavWriter::PCM_16;
+    
+    if(format == "24")
+    {
+        fmt = MyWavWriter::PCM_24;
+    }
+    else if(format == "float")
+    {
+        fmt = MyWavWriter::FLOAT_32;
+    }
+    
+    MySynthEngine engine(rate, 1, 0);
+    MySynthVoice& voice = *engine.GetLine(0);
+    voice.SetPreset(preset, 0);
+    
+    const unsigned long frameCount = ceil(bars * MyPatternBank::STEPS_PER_BAR *
+                                          voice.GetStepLength());
+    
+    MyOfflineRenderer renderer(&engine);
+    double renderTime = 0.0;
+    
+    for(const Entry& entry : entries)
+    {
+        for(int i = 0; i < entry.pattern.length; i++)
+        {
+            voice.SetNote(0, i, entry.pattern.notes[i]);
+        }
+        
+        voice.SetPatternLength(0, entry.pattern.length);
+        
+        std::string path = output + "/" + entry.name + "_" +
+                           std::to_string(entry.line) + ".wav";
+        
+        if(!renderer.Render(path, frameCount, fmt))
+        {
+            std::cerr << "Could not write " << path << std::endl;
+            return 1;
+        }
+        
+        renderTime += renderer.GetRenderTime();
+    }
+    
+    double seconds = entries.size() * frameCount / rate;
+    std::cout << "Rendered " << entries.size() << " files in "
+              << renderTime * 1000.0 << " ms ("
+              << seconds / std::max(renderTime, 1e-9) << "x realtime)"
+              << std::endl;
+    
+    return errors == 0 ? 0 : 1;
+}
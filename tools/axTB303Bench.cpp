@@ -0,0 +1,413 @@
+// DSP benchmarks.
+//
+// axTB303Bench [options] [oscillator|filter|envelope|engine|pool ...]
+//   oscillator : MyOscillator::ProcessBlock for every waveform.
+//   filter     : MyTB303Filter::ProcessBlock, fixed and modulated cutoff.
+//   envelope   : per-sample double envelope loop on interleaved stereo that
+//                used to run in the audio callback versus the mono block path
+//                (MyEnvelopeBlock, MyApplyGain, MyFanOut).
+//   engine     : MySynthEngine::Process, the whole audio callback minus the
+//                command queue, on a single thread for 1 to 16 voices.
+//   pool       : the same for 8 voices spread over 0 to 3 MyWorkerPool
+//                threads, after an idle gap every few blocks as between
+//                callbacks. Includes the cost of waking the workers.
+//
+//   --quick            Fewer block sizes and sample rates.
+//   --csv results.csv  One row per measurement, for tracking over time.
+//
+// Each measurement runs at block sizes from 32 to 4096 frames and reports
+// ns per output sample and how many would fit in one core in real time.
+
+#include "../MyPatternText.h"
+#include "../MySynthEngine.h"
+#include "../MyVectorOps.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Measurement grid, see --quick.
+static std::vector<unsigned long> blockSizes = { 32, 64, 128, 256, 512,
+                                                 1024, 2048, 4096 };
+static std::vector<double> sampleRates = { 44100.0, 48000.0, 96000.0 };
+
+// Samples processed per measurement, whatever the block size.
+static const unsigned long BENCH_SAMPLES = 1 << 21;
+
+static FILE* csv = nullptr;
+
+/// ns is per output sample of one voice. A core has 1e9 / sampleRate ns for
+/// each sample in real time.
+static void Report(const char* bench,
+                   const std::string& variant,
+                   const double& sampleRate,
+                   const unsigned long& frames,
+                   const int& voices,
+                   const double& ns)
+{
+    const double perCore = 1e9 / (sampleRate * ns);
+    
+    printf("  %-10s %6.0f Hz %5lu frames %3d voices : %8.3f ns/sample, "
+           "%8.1f voices/core\n", variant.c_str(), sampleRate, frames,
+           voices, ns, perCore);
+    
+    if(csv != nullptr)
+    {
+        fprintf(csv, "%s,%s,%.0f,%lu,%d,%.4f,%.2f\n", bench, variant.c_str(),
+                sampleRate, frames, voices, ns, perCore);
+    }
+}
+
+// The loop CallbackAudio used to run, kept as the reference.
+static void LegacyEnvelope(float* output,
+                           const unsigned long& frameCount,
+                           double& decayIndex,
+                           const double& decayTime,
+                           const double& attackTime,
+                           const double& volume)
+{
+    double v = 0.0;
+    
+    for(unsigned long i = 0; i < frameCount; i++)
+    {
+        decayIndex++;
+        
+        if(decayIndex >= decayTime)
+        {
+            v = 0.0;
+        }
+        else if(decayIndex <= attackTime * 1.5)
+        {
+            v = std::max(0.0, std::min(decayIndex / attackTime, 1.0));
+        }
+        else
+        {
+            v = std::max(0.0, std::min(1.0 - decayIndex / decayTime, 1.0));
+        }
+        
+        output[0] = output[0] * v * volume;
+        output[1] = output[1] * v * volume;
+        output += 2;
+    }
+}
+
+template<typename Func>
+static double NanoSecondsPerFrame(Func func,
+                                  const unsigned long& frameCount,
+                                  const int& numBlocks)
+{
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    
+    for(int b = 0; b < numBlocks; b++)
+    {
+        func(b);
+    }
+    
+    double ns = std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now() - start).count();
+    
+    return ns / (double(frameCount) * numBlocks);
+}
+
+static int GetNumBlocks(const unsigned long& frameCount)
+{
+    return (int)std::max(BENCH_SAMPLES / frameCount, 1ul);
+}
+
+static void BenchOscillator()
+{
+    static const char* names[] = { "sine", "triangle", "square", "saw",
+                                   "pulse" };
+    
+    std::cout << "oscillator" << std::endl;
+    
+    for(int w = MyOscillator::SINE; w <= MyOscillator::PULSE; w++)
+    {
+        for(double rate : sampleRates)
+        {
+            for(unsigned long frames : blockSizes)
+            {
+                MyOscillator osc;
+                osc.SetSampleRate(rate);
+                osc.SetWaveform((MyOscillator::Waveform)w);
+                
+                std::vector<float> out(frames);
+                std::vector<float> freq(frames, 110.0f);
+                
+                double ns = NanoSecondsPerFrame([&](int b)
+                {
+                    // Sweep the pitch so the BLEP corrections move around.
+                    std::fill(freq.begin(), freq.end(), 55.0f + (b & 63) * 8.0f);
+                    osc.ProcessBlock(out.data(), freq.data(), frames);
+                }, frames, GetNumBlocks(frames));
+                
+                Report("oscillator", names[w], rate, frames, 1, ns);
+            }
+        }
+    }
+}
+
+static void BenchFilter()
+{
+    std::cout << "filter" << std::endl;
+    
+    for(int modulated = 0; modulated < 2; modulated++)
+    {
+        for(double rate : sampleRates)
+        {
+            for(unsigned long frames : blockSizes)
+            {
+                MyTB303Filter filter;
+                filter.SetSampleRate(rate);
+                filter.SetFreq(800.0);
+                filter.SetRes(0.8);
+                
+                std::vector<float> input(frames);
+                std::vector<float> buffer(frames);
+                std::vector<float> mod(frames);
+                
+                // Saw input and a decaying envelope sweep, like a note.
+                for(unsigned long i = 0; i < frames; i++)
+                {
+                    input[i] = 2.0f * ((i % 100) / 100.0f) - 1.0f;
+                    mod[i] = 3.0f * (1.0f - (float)i / frames);
+                }
+                
+                double ns = NanoSecondsPerFrame([&](int)
+                {
+                    std::copy(input.begin(), input.end(), buffer.begin());
+                    
+                    if(modulated)
+                    {
+                        filter.ProcessBlock(buffer.data(), mod.data(), frames);
+                    }
+                    else
+                    {
+                        filter.ProcessBlock(buffer.data(), frames);
+                    }
+                }, frames, GetNumBlocks(frames));
+                
+                Report("filter", modulated ? "modulated" : "fixed", rate,
+                       frames, 1, ns);
+            }
+        }
+    }
+}
+
+static void BenchEnvelope()
+{
+    std::cout << "envelope" << std::endl;
+    
+    for(double sampleRate : sampleRates)
+    {
+        for(unsigned long frames : blockSizes)
+        {
+            const double decayTime = sampleRate / 4.0;
+            const double attackTime = 0.00045 * sampleRate;
+            const int numBlocks = GetNumBlocks(frames);
+            
+            // Fresh input each block like the oscillator output, otherwise the
+            // buffer decays into denormals.
+            std::vector<float> input(frames * 2, 0.5f);
+            std::vector<float> buffer(frames * 2);
+            std::vector<float> mono(frames);
+            std::vector<float> env(frames);
+            double index = 0.0;
+            
+            double legacy = NanoSecondsPerFrame([&](int b)
+            {
+                // Restart a note every few blocks so all branches are taken.
+                if(b % 64 == 0)
+                {
+                    index = 0.0;
+                }
+                
+                std::copy(input.begin(), input.end(), buffer.begin());
+                LegacyEnvelope(buffer.data(), frames, index, decayTime,
+                               attackTime, 0.8);
+            }, frames, numBlocks);
+            
+            index = 0.0;
+            
+            double block = NanoSecondsPerFrame([&](int b)
+            {
+                if(b % 64 == 0)
+                {
+                    index = 0.0;
+                }
+                
+                std::copy(input.begin(), input.begin() + frames, mono.begin());
+                MyEnvelopeBlock(env.data(), frames, (float)(index + 1.0), 1.0f,
+                                (float)sampleRate, (float)(1.0 / attackTime),
+                                (float)(1.0 / decayTime), 0.8f);
+                MyApplyGain(mono.data(), env.data(), frames);
+                MyFanOut(mono.data(), buffer.data(), frames, 2);
+                index = std::min(index + frames, sampleRate);
+            }, frames, numBlocks);
+            
+            Report("envelope", "legacy", sampleRate, frames, 1, legacy);
+            Report("envelope", "block", sampleRate, frames, 1, block);
+        }
+    }
+}
+
+static void SetupEngine(MySynthEngine& engine, const int& voices)
+{
+    MyPatternBank::Pattern pattern;
+    MyPatternText::Parse("0 12a 3s 7 - 5u 0 10d 0 12a 3 7s 7 - 0 5", pattern);
+    
+    for(int v = 0; v < voices; v++)
+    {
+        MySynthVoice* voice = engine.GetLine(v);
+        
+        for(int i = 0; i < pattern.length; i++)
+        {
+            voice->SetNote(0, i, pattern.notes[i]);
+        }
+        
+        voice->SetPatternLength(0, pattern.length);
+        voice->SetWaveformType(v % 2 ? MyOscillator::SAW :
+                                       MyOscillator::SQUARE);
+        voice->SetEnvMod(0.6);
+    }
+}
+
+static void BenchEngine()
+{
+    std::cout << "engine" << std::endl;
+    
+    for(int voices : { 1, 2, 4, 8, 16 })
+    {
+        for(double rate : sampleRates)
+        {
+            for(unsigned long frames : blockSizes)
+            {
+                // No workers, voices per core is about a single core.
+                MySynthEngine engine(rate, voices, 0);
+                SetupEngine(engine, voices);
+                
+                std::vector<float> output(frames * 2);
+                const int numBlocks = (int)std::max(
+                    BENCH_SAMPLES / (frames * voices * 4), 1ul);
+                
+                double ns = NanoSecondsPerFrame([&](int)
+                {
+                    engine.Process(output.data(), frames);
+                }, frames, numBlocks);
+                
+                Report("engine", "callback", rate, frames, voices,
+                       ns / voices);
+            }
+        }
+    }
+}
+
+static void BenchPool()
+{
+    std::cout << "pool" << std::endl;
+    
+    const int voices = 8;
+    
+    for(int threads : { 0, 1, 3 })
+    {
+        for(double rate : sampleRates)
+        {
+            for(unsigned long frames : blockSizes)
+            {
+                MySynthEngine engine(rate, voices, threads);
+                SetupEngine(engine, voices);
+                
+                std::vector<float> output(frames * 2);
+                const int numBlocks = (int)std::max(
+                    BENCH_SAMPLES / (frames * voices * 4), 1ul);
+                
+                // Only the callbacks are timed. Every 8th one first waits
+                // half its period, the workers find an idle pool like
+                // between real callbacks.
+                double total = 0.0;
+                
+                for(int b = 0; b < numBlocks; b++)
+                {
+                    if(b % 8 == 0)
+                    {
+                        std::this_thread::sleep_for(
+                            std::chrono::duration<double>(frames / rate / 2));
+                    }
+                    
+                    std::chrono::steady_clock::time_point start =
+                        std::chrono::steady_clock::now();
+                    engine.Process(output.data(), frames);
+                    total += std::chrono::duration<double, std::nano>(
+                        std::chrono::steady_clock::now() - start).count();
+                }
+                
+                char variant[32];
+                snprintf(variant, sizeof(variant), "%d threads", threads);
+                Report("pool", variant, rate, frames, voices,
+                       total / ((double)numBlocks * frames * voices));
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> benches;
+    
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        
+        if(arg == "--quick")
+        {
+            blockSizes = { 64, 512, 4096 };
+            sampleRates = { 44100.0 };
+        }
+        else if(arg == "--csv" && i + 1 < argc)
+        {
+            csv = fopen(argv[++i], "w");
+            
+            if(csv == nullptr)
+            {
+                std::cerr << "Could not write " << argv[i] << std::endl;
+                return 1;
+            }
+            
+            fprintf(csv, "bench,variant,sample_rate,block,voices,"
+                         "ns_per_sample,voices_per_core\n");
+        }
+        else if(arg[0] != '-')
+        {
+            benches.push_back(arg);
+        }
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+    
+    auto selected = [&](const char* name)
+    {
+        return benches.empty() ||
+               std::find(benches.begin(), benches.end(), name) != benches.end();
+    };
+    
+    if(selected("oscillator")) BenchOscillator();
+    if(selected("filter")) BenchFilter();
+    if(selected("envelope")) BenchEnvelope();
+    if(selected("engine")) BenchEngine();
+    if(selected("pool")) BenchPool();
+    
+    if(csv != nullptr)
+    {
+        fclose(csv);
+    }
+    
+    return 0;
+}
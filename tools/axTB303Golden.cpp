@@ -0,0 +1,372 @@
+// Golden output regression check.
+//
+// axTB303Golden --check tools/golden   Renders every case again and
+//                                      compares it with the reference.
+//                                      Exits 1 if any case is out of
+//                                      tolerance.
+// axTB303Golden --record tools/golden  Writes the references of a build
+//                                      known to sound right.
+//   --case name                        Only this case, repeatable.
+//   --rms -90                          Max error RMS in dB below the
+//                                      reference RMS.
+//   --peak 0.001                       Max absolute sample error.
+//   --spectral 0.1                     Max difference in dB of any third
+//                                      octave band of the long term
+//                                      spectrum.
+//
+// A reference is <case>.wav, float mono : EXCERPT_FRAMES frames from a
+// little before each of EXCERPT_STEPS, end to end. That keeps it small
+// enough to live in the tree while still catching a step that moved, a
+// note that changed or a phase that drifted. The spectral check is the one
+// that matters for fast-math and SIMD variants, which may move samples
+// slightly without changing the sound.
+
+#include "../MyOfflineRenderer.h"
+#include "../MyPatternText.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+struct Case
+{
+    const char* name;
+    const char* pattern;
+    MyOscillator::Waveform waveform;
+    double cutoff;
+    double res;
+    double envMod;
+    double decay;
+    double accent;
+    int oversampling;
+};
+
+// Fixed forever, changing one means recording its reference again.
+static const Case cases[] =
+{
+    { "square_basic", "0 0 12 0 3 0 7 0 0 0 12 0 5 0 10 0",
+      MyOscillator::SQUARE, 2000.0, 0.3, 0.5, 0.5, 0.5, 1 },
+    { "saw_acid", "0 12a 3s 7 - 5u 0 10d 0 12a 3 7s 7 - 0 5",
+      MyOscillator::SAW, 600.0, 0.85, 0.8, 0.3, 0.8, 1 },
+    { "saw_oversampled", "0 12a 3s 7 - 5u 0 10d 0 12a 3 7s 7 - 0 5",
+      MyOscillator::SAW, 600.0, 0.85, 0.8, 0.3, 0.8, 4 },
+    { "pulse_slides", "0s 7s 12s 7 0 - 3as 10s 12 - 0 0 5us 3 0 -",
+      MyOscillator::PULSE, 1200.0, 0.6, 0.6, 0.7, 0.5, 2 },
+    { "triangle_low", "0d 0d 7d 0d 5d 0d 3d 0d",
+      MyOscillator::TRIANGLE, 5000.0, 0.1, 0.2, 0.9, 0.0, 1 },
+    { "sine_high", "12u 7u 0u 12au - 5u 3u 0u",
+      MyOscillator::SINE, 20000.0, 0.0, 0.0, 0.5, 0.5, 1 },
+};
+
+static const int NUM_CASES = sizeof(cases) / sizeof(cases[0]);
+static const double SAMPLE_RATE = 44100.0;
+static const int BARS = 2;
+
+// Steps of the two bars the excerpts start on, and how many frames before
+// the step start each one begins.
+static const int EXCERPT_STEPS[] = { 0, 5, 19, 30 };
+static const int NUM_EXCERPTS = sizeof(EXCERPT_STEPS) /
+                                sizeof(EXCERPT_STEPS[0]);
+static const unsigned long EXCERPT_FRAMES = 2048;
+static const unsigned long EXCERPT_LEAD = 256;
+
+static bool Setup(MySynthEngine& engine, const Case& c)
+{
+    MySynthVoice* voice = engine.GetLine(0);
+    MyPatternBank::Pattern pattern;
+    
+    if(!MyPatternText::Parse(c.pattern, pattern))
+    {
+        return false;
+    }
+    
+    for(int i = 0; i < pattern.length; i++)
+    {
+        voice->SetNote(0, i, pattern.notes[i]);
+    }
+    
+    voice->SetPatternLength(0, pattern.length);
+    voice->SetOversampling(c.oversampling);
+    voice->SetWaveformType(c.waveform);
+    voice->SetFilterFreq(c.cutoff);
+    voice->SetFilterRes(c.res);
+    voice->SetEnvMod(c.envMod);
+    voice->SetDecay(c.decay);
+    voice->SetAccent(c.accent);
+    voice->SetVolume(0.8);
+    return true;
+}
+
+static unsigned long GetFrameCount(MySynthEngine& engine)
+{
+    return (unsigned long)ceil(BARS * MyPatternBank::STEPS_PER_BAR *
+                               engine.GetLine(0)->GetStepLength());
+}
+
+/// First channel of the excerpts of an interleaved stereo render, the
+/// voice is mono all the way through.
+static std::vector<float> GetExcerpts(const std::vector<float>& render,
+                                      const double& stepLength)
+{
+    const unsigned long frameCount = render.size() / 2;
+    std::vector<float> excerpts;
+    
+    for(int e = 0; e < NUM_EXCERPTS; e++)
+    {
+        const unsigned long step = (unsigned long)(EXCERPT_STEPS[e] *
+                                                   stepLength);
+        const unsigned long start =
+            std::min(step - std::min(step, EXCERPT_LEAD),
+                     frameCount - EXCERPT_FRAMES);
+        
+        for(unsigned long i = start; i < start + EXCERPT_FRAMES; i++)
+        {
+            excerpts.push_back(render[i * 2]);
+        }
+    }
+    
+    return excerpts;
+}
+
+// In place radix-2 FFT, size is a power of two.
+static void FFT(std::vector<std::complex<double>>& x)
+{
+    const size_t n = x.size();
+    
+    for(size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        
+        for(; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        
+        j ^= bit;
+        
+        if(i < j)
+        {
+            std::swap(x[i], x[j]);
+        }
+    }
+    
+    for(size_t len = 2; len <= n; len <<= 1)
+    {
+        const std::complex<double> w = std::polar(1.0, -2.0 * M_PI / len);
+        
+        for(size_t i = 0; i < n; i += len)
+        {
+            std::complex<double> wk(1.0, 0.0);
+            
+            for(size_t k = 0; k < len / 2; k++, wk *= w)
+            {
+                std::complex<double> a = x[i + k];
+                std::complex<double> b = x[i + k + len / 2] * wk;
+                x[i + k] = a + b;
+                x[i + k + len / 2] = a - b;
+            }
+        }
+    }
+}
+
+/// Long term power in third octave bands from 20 Hz of a mono buffer. Hann
+/// windows of 2048 with half overlap.
+static std::vector<double> GetBands(const float* data,
+                                    const unsigned long& frameCount)
+{
+    const size_t size = 2048;
+    std::vector<double> power(size / 2, 0.0);
+    std::vector<std::complex<double>> x(size);
+    
+    for(unsigned long start = 0; start + size <= frameCount; start += size / 2)
+    {
+        for(size_t i = 0; i < size; i++)
+        {
+            double w = 0.5 - 0.5 * cos(2.0 * M_PI * i / size);
+            x[i] = w * data[start + i];
+        }
+        
+        FFT(x);
+        
+        for(size_t i = 0; i < size / 2; i++)
+        {
+            power[i] += std::norm(x[i]);
+        }
+    }
+    
+    std::vector<double> bands;
+    
+    for(double low = 20.0; low < SAMPLE_RATE / 2.0; low *= pow(2.0, 1.0 / 3.0))
+    {
+        const double high = low * pow(2.0, 1.0 / 3.0);
+        double sum = 0.0;
+        
+        for(size_t i = 0; i < size / 2; i++)
+        {
+            double freq = i * SAMPLE_RATE / size;
+            
+            if(freq >= low && freq < high)
+            {
+                sum += power[i];
+            }
+        }
+        
+        bands.push_back(sum);
+    }
+    
+    return bands;
+}
+
+/// Largest difference in dB between the bands that are no more than 80 dB
+/// below the loudest one, quieter bands are mostly numerical noise.
+static double GetSpectralDiff(const float* ref,
+                              const float* out,
+                              const unsigned long& frameCount)
+{
+    std::vector<double> a = GetBands(ref, frameCount);
+    std::vector<double> b = GetBands(out, frameCount);
+    const double floor = *std::max_element(a.begin(), a.end()) * 1e-8;
+    double diff = 0.0;
+    
+    for(size_t i = 0; i < a.size(); i++)
+    {
+        if(a[i] > floor)
+        {
+            diff = std::max(diff, fabs(10.0 * log10((b[i] + 1e-30) / a[i])));
+        }
+    }
+    
+    return diff;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string recordDir, checkDir;
+    std::vector<std::string> only;
+    double maxRms = -90.0, maxPeak = 0.001, maxSpectral = 0.1;
+    
+    for(int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        const char* value = argv[i + 1];
+        
+        if(arg == "--record") recordDir = value;
+        else if(arg == "--check") checkDir = value;
+        else if(arg == "--case") only.push_back(value);
+        else if(arg == "--rms") maxRms = atof(value);
+        else if(arg == "--peak") maxPeak = atof(value);
+        else if(arg == "--spectral") maxSpectral = atof(value);
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+    
+    if(recordDir.empty() == checkDir.empty())
+    {
+        std::cerr << "Usage : axTB303Golden --record dir | --check dir"
+                  << std::endl;
+        return 1;
+    }
+    
+    int failures = 0;
+    
+    for(int c = 0; c < NUM_CASES; c++)
+    {
+        const Case& test = cases[c];
+        
+        if(!only.empty() &&
+           std::find(only.begin(), only.end(), test.name) == only.end())
+        {
+            continue;
+        }
+        
+        MySynthEngine engine(SAMPLE_RATE, 1, 0);
+        
+        if(!Setup(engine, test))
+        {
+            std::cerr << "Bad pattern in case " << test.name << std::endl;
+            return 1;
+        }
+        
+        std::vector<float> render(GetFrameCount(engine) * 2);
+        MyOfflineRenderer renderer(&engine);
+        renderer.Render(render.data(), render.size() / 2);
+        
+        const std::vector<float> out =
+            GetExcerpts(render, engine.GetLine(0)->GetStepLength());
+        
+        if(!recordDir.empty())
+        {
+            std::string path = recordDir + "/" + test.name + ".wav";
+            MyWavWriter wav;
+            
+            if(!wav.Open(path, SAMPLE_RATE, 1, MyWavWriter::FLOAT_32) ||
+               !wav.Write(out.data(), out.size()) || !wav.Close())
+            {
+                std::cerr << "Could not write " << path << std::endl;
+                return 1;
+            }
+            
+            std::cout << path << " : " << out.size() << " frames"
+                      << std::endl;
+            continue;
+        }
+        
+        std::string path = checkDir + "/" + test.name + ".wav";
+        MyWavReader ref;
+        
+        if(!ref.Read(path))
+        {
+            std::cerr << "Could not read " << path << std::endl;
+            ++failures;
+            continue;
+        }
+        
+        if(ref.GetNumChannels() != 1 || ref.GetFrameCount() != out.size())
+        {
+            std::cout << "FAIL " << test.name << " : reference has "
+                      << ref.GetFrameCount() << " frames, expected "
+                      << out.size() << std::endl;
+            ++failures;
+            continue;
+        }
+        
+        const float* data = ref.GetData();
+        double errSum = 0.0, refSum = 0.0, peak = 0.0;
+        
+        for(unsigned long i = 0; i < out.size(); i++)
+        {
+            double err = out[i] - data[i];
+            errSum += err * err;
+            refSum += data[i] * data[i];
+            peak = std::max(peak, fabs(err));
+        }
+        
+        const double rms = errSum == 0.0 ? -INFINITY :
+                           10.0 * log10(errSum / std::max(refSum, 1e-30));
+        const double spectral = GetSpectralDiff(data, out.data(), out.size());
+        const bool ok = rms <= maxRms && peak <= maxPeak &&
+                        spectral <= maxSpectral;
+        
+        printf("%s %-16s rms %7.1f dB, peak %.2e, spectral %.4f dB\n",
+               ok ? "ok  " : "FAIL", test.name, rms, peak, spectral);
+        
+        if(!ok)
+        {
+            ++failures;
+        }
+    }
+    
+    if(failures > 0)
+    {
+        std::cout << failures << " case(s) out of tolerance" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,262 @@
+// MIDI sync and live input check, through a loopback port.
+//
+// axTB303Midi --listen port -o out.wav [options]
+//   Plays the synth in real time from the MIDI read on port and records it.
+//   --seconds 8                       How long to listen.
+//   --sync                            Sequencer follows MIDI clock.
+//   --pattern "0 3 7a 12us - 5d ..."  Sequencer pattern, see MyPatternText.
+//                                     None plays only the live notes.
+//   --block 256                       Frames per Process call.
+//   Prints each step with its frame and the spread of the step lengths.
+//
+// axTB303Midi --send port [options]
+//   Sends Start, 24 ppqn clock and Stop, like a drum machine.
+//   --bpm 125 --bars 4
+//   --jitter 2                        Random clock jitter in ms, either way.
+//   --notes                           Also a note on every step.
+//
+// Loopback with a named pipe :
+//   mkfifo /tmp/tb303.mid
+//   axTB303Midi --listen /tmp/tb303.mid -o sync.wav --sync --pattern "..." &
+//   axTB303Midi --send /tmp/tb303.mid --jitter 2
+//
+// or with the ALSA virtual rawmidi driver, which other MIDI software can
+// also connect to (aconnect) :
+//   modprobe snd-virmidi
+//   axTB303Midi --listen /dev/snd/midiC1D0 ... &
+//   axTB303Midi --send /dev/snd/midiC1D1
+
+#include "../MyPatternText.h"
+#include "../MySynth.h"
+#include "../MyWavFile.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static int Send(const std::string& port,
+                const double& bpm,
+                const int& bars,
+                const double& jitter,
+                const bool& notes)
+{
+    int fd = open(port.c_str(), O_WRONLY);
+    
+    if(fd < 0)
+    {
+        std::cerr << "Could not open " << port << std::endl;
+        return 1;
+    }
+    
+    const double tick = 60.0 / (bpm * MyMidiClock::TICKS_PER_QUARTER);
+    const int numTicks = bars * 4 * MyMidiClock::TICKS_PER_QUARTER;
+    const int ticksPerStep = MyMidiClock::TICKS_PER_QUARTER / 4;
+    static const int arpeggio[] = { 0, 12, 3, 7, 0, 10, 12, 5 };
+    
+    std::mt19937 random(303);
+    std::uniform_real_distribution<double> spread(-jitter, jitter);
+    
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+    
+    unsigned char msg[3] = { MyMidiMessage::START };
+    std::this_thread::sleep_until(start);
+    (void)write(fd, msg, 1);
+    
+    for(int i = 0; i < numTicks; i++)
+    {
+        const double time = i * tick + spread(random) * 0.001;
+        std::this_thread::sleep_until(start + std::chrono::microseconds(
+            (long)(std::max(time, 0.0) * 1e6)));
+        
+        msg[0] = MyMidiMessage::CLOCK;
+        (void)write(fd, msg, 1);
+        
+        if(notes && i % ticksPerStep == 0)
+        {
+            const int step = i / ticksPerStep;
+            const int note = MySynth::BASE_MIDI_NOTE + arpeggio[step % 8];
+            
+            // Off for the previous one, then the new one, accent every beat.
+            msg[0] = MyMidiMessage::NOTE_OFF;
+            msg[1] = MySynth::BASE_MIDI_NOTE + arpeggio[(step + 7) % 8];
+            msg[2] = 0;
+            (void)write(fd, msg, 3);
+            
+            msg[0] = MyMidiMessage::NOTE_ON;
+            msg[1] = note;
+            msg[2] = step % 4 == 0 ? 120 : 80;
+            (void)write(fd, msg, 3);
+        }
+    }
+    
+    msg[0] = MyMidiMessage::STOP;
+    (void)write(fd, msg, 1);
+    close(fd);
+    
+    std::cout << "Sent " << numTicks << " ticks at " << bpm << " bpm, "
+              << jitter << " ms jitter" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string listen, send, output, pattern;
+    double seconds = 8.0, bpm = 125.0, jitter = 0.0;
+    int bars = 4, block = 256;
+    bool sync = false, notes = false;
+    
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        
+        if(arg == "--sync")
+        {
+            sync = true;
+            continue;
+        }
+        
+        if(arg == "--notes")
+        {
+            notes = true;
+            continue;
+        }
+        
+        if(i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 1;
+        }
+        
+        const char* value = argv[++i];
+        
+        if(arg == "--listen") listen = value;
+        else if(arg == "--send") send = value;
+        else if(arg == "-o" || arg == "--output") output = value;
+        else if(arg == "--pattern") pattern = value;
+        else if(arg == "--seconds") seconds = atof(value);
+        else if(arg == "--bpm") bpm = atof(value);
+        else if(arg == "--bars") bars = atoi(value);
+        else if(arg == "--jitter") jitter = atof(value);
+        else if(arg == "--block") block = std::max(1, atoi(value));
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+    
+    if(!send.empty())
+    {
+        return Send(send, bpm, bars, jitter, notes);
+    }
+    
+    if(listen.empty() || output.empty())
+    {
+        std::cerr << "Usage : axTB303Midi --listen port -o out.wav [options]"
+                  << std::endl
+                  << "        axTB303Midi --send port [options]" << std::endl;
+        return 1;
+    }
+    
+    const double rate = 44100.0;
+    MySynth synth(rate);
+    synth.SetVolume(0.8);
+    synth.SetEnvMod(0.6);
+    synth.SetFilterFreq(1500.0);
+    synth.SetFilterRes(0.7);
+    
+    if(!pattern.empty())
+    {
+        MyPatternBank::Pattern steps;
+        
+        if(!MyPatternText::Parse(pattern.c_str(), steps))
+        {
+            std::cerr << "Invalid pattern : " << pattern << std::endl;
+            return 1;
+        }
+        
+        synth.SetPatternLength(steps.length);
+        
+        for(int i = 0; i < steps.length; i++)
+        {
+            synth.SetNoteInfo(i, steps.notes[i]);
+        }
+    }
+    
+    synth.SetMidiSync(sync);
+    
+    if(!synth.OpenMidiInput(listen))
+    {
+        std::cerr << "Could not open " << listen << std::endl;
+        return 1;
+    }
+    
+    MyWavWriter wav;
+    
+    if(!wav.Open(output, rate, 2, MyWavWriter::PCM_16))
+    {
+        std::cerr << "Could not write " << output << std::endl;
+        return 1;
+    }
+    
+    // Stands in for the audio callback : one block per period, on time.
+    std::vector<float> buffer(block * 2);
+    std::vector<unsigned long long> steps;
+    const unsigned long total = (unsigned long)(seconds * rate);
+    const std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+    
+    synth.SetRunning(true);
+    
+    for(unsigned long frame = 0; frame < total; frame += block)
+    {
+        std::this_thread::sleep_until(start + std::chrono::microseconds(
+            (long)((frame + block) / rate * 1e6)));
+        
+        synth.Process(buffer.data(), block);
+        wav.Write(buffer.data(), block);
+        
+        MySynth::StepEvent event;
+        
+        while(synth.PopStepEvent(event))
+        {
+            steps.push_back(event.frame);
+            std::cout << "step " << event.step + 1 << " at frame "
+                      << event.frame << std::endl;
+        }
+    }
+    
+    synth.SetRunning(false);
+    synth.CloseMidiInput();
+    wav.Close();
+    
+    // Spread of the step lengths, the raw clock would show the jitter.
+    if(steps.size() > 2)
+    {
+        double sum = 0.0, sum2 = 0.0;
+        const int n = (int)steps.size() - 1;
+        
+        for(int i = 0; i < n; i++)
+        {
+            const double length = (double)(steps[i + 1] - steps[i]);
+            sum += length;
+            sum2 += length * length;
+        }
+        
+        const double mean = sum / n;
+        const double spread = sqrt(std::max(0.0, sum2 / n - mean * mean));
+        
+        std::cout << steps.size() << " steps, " << mean << " frames each ("
+                  << 60.0 * rate / (mean * 4.0) << " bpm), spread "
+                  << spread << " frames (" << spread / rate * 1000.0
+                  << " ms)" << std::endl;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,301 @@
+// Headless pattern renderer.
+//
+// axTB303Render -o loop.wav [options]
+//   --pattern "0 3 7a 12us - 5d ..."  One token per step : semitone 0-12
+//                                     followed by u (up), d (down),
+//                                     a (accent), s (slide). "-" is a rest.
+//                                     1 to 64 steps. Repeat the option for
+//                                     patterns 1, 2...
+//   --pattern-file loops.pat          Same, one pattern per line, see
+//                                     MyPatternText.
+//   --song "0 0 1 2"                  Chain of patterns played in order.
+//   --bpm 120 --bars 4 --rate 44100 --oversampling 1
+//   --wave square|saw|sine|triangle|pulse --pw 0.5
+//   --cutoff 20000 --res 0 --envmod 0.5 --decay 0.5 --tuning 1.0
+//   --accent 0.5
+//   --scale "0,-10,4,..."             Cents offset of each of the 12
+//                                     pitch classes (default equal).
+//   --volume 0.8
+//   --preset lib.303p --index 0       Starting point, see MyPresetFile.
+//   --save-preset out.303p            Saves the settings and pattern 0.
+//   --tail 0.5 --format 16|24|float
+//   --block 256 --profile blocks.csv  Times every block like the audio
+//                                     callback, see MyProfiler.
+//
+// Debug builds (MY_RT_CHECK) fail if the render path allocates, locks or
+// does I/O, see MyRealtimeCheck.
+
+#include "../MyOfflineRenderer.h"
+#include "../MyPatternText.h"
+#include "../MyRealtimeCheck.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+static void SetPattern(MySynthVoice* voice,
+                       const int& index,
+                       const MyPatternBank::Pattern& pattern)
+{
+    for(int i = 0; i < pattern.length; i++)
+    {
+        voice->SetNote(index, i, pattern.notes[i]);
+    }
+    
+    voice->SetPatternLength(index, pattern.length);
+}
+
+static MyOscillator::Waveform ParseWaveform(const std::string& wave)
+{
+    if(wave == "saw") return MyOscillator::SAW;
+    if(wave == "sine") return MyOscillator::SINE;
+    if(wave == "triangle") return MyOscillator::TRIANGLE;
+    if(wave == "pulse") return MyOscillator::PULSE;
+    return MyOscillator::SQUARE;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string output, scale, song, savePreset, profile, format = "16";
+    std::vector<MyPatternBank::Pattern> patterns;
+    double rate = 44100.0, tail = 0.0;
+    int bars = 4, oversampling = 1, block = 4096;
+    
+    MyPreset preset;
+    preset.volume = 0.8;
+    
+    // The preset is the starting point, every other option overrides it.
+    for(int i = 1; i + 1 < argc; i++)
+    {
+        if(std::string(argv[i]) == "--preset")
+        {
+            MyPresetFile file;
+            int index = 0;
+            
+            for(int j = 1; j + 1 < argc; j++)
+            {
+                if(std::string(argv[j]) == "--index")
+                {
+                    index = atoi(argv[j + 1]);
+                }
+            }
+            
+            if(!file.Open(argv[i + 1]) || !file.Read(index, preset))
+            {
+                std::cerr << "Could not read preset " << index << " from "
+                          << argv[i + 1] << std::endl;
+                return 1;
+            }
+        }
+    }
+    
+    for(int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        
+        if(value == nullptr)
+        {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return 1;
+        }
+        
+        if(arg == "-o" || arg == "--output") output = value;
+        else if(arg == "--pattern")
+        {
+            MyPatternBank::Pattern pattern;
+            
+            if(!MyPatternText::Parse(value, pattern))
+            {
+                std::cerr << "Invalid pattern : " << value << std::endl;
+                return 1;
+            }
+            
+            patterns.push_back(pattern);
+        }
+        else if(arg == "--pattern-file")
+        {
+            MyPatternText file;
+            MyPatternBank::Pattern pattern;
+            
+            if(!file.Open(value))
+            {
+                std::cerr << "Could not open " << value << std::endl;
+                return 1;
+            }
+            
+            while(file.Read(pattern))
+            {
+                patterns.push_back(pattern);
+            }
+            
+            if(file.HasError())
+            {
+                std::cerr << value << ":" << file.GetLine()
+                          << " : invalid pattern" << std::endl;
+                return 1;
+            }
+        }
+        else if(arg == "--song") song = value;
+        else if(arg == "--scale") scale = value;
+        else if(arg == "--preset" || arg == "--index") {}
+        else if(arg == "--save-preset") savePreset = value;
+        else if(arg == "--wave") preset.waveform = ParseWaveform(value);
+        else if(arg == "--format") format = value;
+        else if(arg == "--bpm") preset.bpm = atof(value);
+        else if(arg == "--rate") rate = atof(value);
+        else if(arg == "--cutoff") preset.cutoff = atof(value);
+        else if(arg == "--res") preset.res = atof(value);
+        else if(arg == "--envmod") preset.envMod = atof(value);
+        else if(arg == "--pw") preset.pulseWidth = atof(value);
+        else if(arg == "--accent") preset.accent = atof(value);
+        else if(arg == "--decay") preset.decay = atof(value);
+        else if(arg == "--tuning") preset.tuning = atof(value);
+        else if(arg == "--volume") preset.volume = atof(value);
+        else if(arg == "--tail") tail = atof(value);
+        else if(arg == "--bars") bars = atoi(value);
+        else if(arg == "--oversampling") oversampling = atoi(value);
+        else if(arg == "--block") block = atoi(value);
+        else if(arg == "--profile") profile = value;
+        else
+        {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+        
+        ++i;
+    }
+    
+    if(output.empty() && savePreset.empty())
+    {
+        std::cerr << "Usage : axTB303Render -o file.wav [options]" << std::endl;
+        return 1;
+    }
+    
+    MySynthEngine engine(rate, 1, 0);
+    MySynthVoice& voice = *engine.GetLine(0);
+    voice.SetOversampling(oversampling);
+    voice.SetPreset(preset, 0);
+    
+    if(!scale.empty())
+    {
+        double cents[12] = { 0.0 };
+        std::stringstream ss(scale);
+        std::string token;
+        
+        for(int i = 0; i < 12 && std::getline(ss, token, ','); i++)
+        {
+            cents[i] = atof(token.c_str());
+        }
+        
+        voice.SetScale(cents);
+    }
+    
+    if(patterns.size() > MyPatternBank::NUM_PATTERNS)
+    {
+        std::cerr << "At most " << MyPatternBank::NUM_PATTERNS
+                  << " patterns" << std::endl;
+        return 1;
+    }
+    
+    for(int i = 0; i < (int)patterns.size(); i++)
+    {
+        SetPattern(&voice, i, patterns[i]);
+    }
+    
+    if(!savePreset.empty())
+    {
+        preset.pattern.length = voice.GetPatternLength(0);
+        
+        for(int i = 0; i < MyPatternBank::MAX_STEPS; i++)
+        {
+            preset.pattern.notes[i] = voice.GetNote(0, i);
+        }
+        
+        if(!MyPresetFile::Save(savePreset, &preset, 1))
+        {
+            std::cerr << "Could not write " << savePreset << std::endl;
+            return 1;
+        }
+        
+        if(output.empty())
+        {
+            return 0;
+        }
+    }
+    
+    if(!song.empty())
+    {
+        std::istringstream stream(song);
+        int pattern = 0, length = 0;
+        
+        while(stream >> pattern && length < MyPatternBank::MAX_CHAIN)
+        {
+            voice.SetChainEntry(length++, pattern);
+        }
+        
+        voice.SetChainLength(length);
+        voice.SetSongMode(true);
+    }
+    
+    MyWavWriter::Format fmt = MyWavWriter::PCM_16;
+    
+    if(format == "24")
+    {
+        fmt = MyWavWriter::PCM_24;
+    }
+    else if(format == "float")
+    {
+        fmt = MyWavWriter::FLOAT_32;
+    }
+    
+    const unsigned long frameCount = ceil(bars * MyPatternBank::STEPS_PER_BAR *
+                                          voice.GetStepLength() + tail * rate);
+    
+    MyOfflineRenderer renderer(&engine);
+    MyProfiler profiler;
+    renderer.SetBlockSize(block);
+    
+    if(!profile.empty())
+    {
+        if(!profiler.StartExport(profile))
+        {
+            std::cerr << "Could not write " << profile << std::endl;
+            return 1;
+        }
+        
+        renderer.SetProfiler(&profiler);
+    }
+    
+    if(!renderer.Render(output, frameCount, fmt))
+    {
+        std::cerr << "Could not write " << output << std::endl;
+        return 1;
+    }
+    
+    double seconds = renderer.GetFrameCount() / rate;
+    std::cout << output << " : " << renderer.GetFrameCount() << " frames in "
+              << renderer.GetRenderTime() * 1000.0 << " ms ("
+              << seconds / renderer.GetRenderTime() << "x realtime)"
+              << std::endl;
+    
+    if(!profile.empty())
+    {
+        profiler.StopExport();
+        std::cout << profile << " : worst load "
+                  << profiler.GetWorstLoad() * 100.0f << " %, "
+                  << profiler.GetXrunCount() << " xruns" << std::endl;
+    }
+    
+    // Debug builds check the render path like the audio callback.
+    if(MyRealtimeCheck::GetViolationCount() > 0)
+    {
+        std::cerr << MyRealtimeCheck::GetViolationCount()
+                  << " real time violations while rendering" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}